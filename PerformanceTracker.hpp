@@ -17,6 +17,9 @@ public:
     unsigned long search_depth = 0;
     unsigned long nodes_visited = 0;
     unsigned long color_changes = 0;
+    // Lookups answered (or not) by a front cache (FrontCache).
+    unsigned long cache_hits = 0;
+    unsigned long cache_misses = 0;
     std::string operation_name = "";
 
     void reset() {
@@ -28,6 +31,8 @@ public:
       search_depth = 0;
       nodes_visited = 0;
       color_changes = 0;
+      cache_hits = 0;
+      cache_misses = 0;
       operation_name = "";
     }
 
@@ -41,6 +46,10 @@ public:
       std::cout << "Search Depth: " << search_depth << "\n";
       std::cout << "Nodes Visited: " << nodes_visited << "\n";
       std::cout << "Color Changes: " << color_changes << "\n";
+      if (cache_hits + cache_misses > 0) {
+        std::cout << "Cache Hits: " << cache_hits << "\n";
+        std::cout << "Cache Misses: " << cache_misses << "\n";
+      }
       std::cout << "=====================================\n" << std::endl;
     }
   };
@@ -75,6 +84,8 @@ public:
   void incrementNodesVisited() { current_stats.nodes_visited++; }
   void incrementColorChanges() { current_stats.color_changes++; }
   void incrementSearchDepth() { current_stats.search_depth++; }
+  void incrementCacheHits() { current_stats.cache_hits++; }
+  void incrementCacheMisses() { current_stats.cache_misses++; }
 
   void addRotations(unsigned long count) { current_stats.rotations += count; }
   void addComparisons(unsigned long count) {
@@ -95,6 +106,10 @@ public:
   void addColorChanges(unsigned long count) {
     current_stats.color_changes += count;
   }
+  void addCacheHits(unsigned long count) { current_stats.cache_hits += count; }
+  void addCacheMisses(unsigned long count) {
+    current_stats.cache_misses += count;
+  }
 
   const Stats &getStats() const { return current_stats; }
   void printStats() const { current_stats.print(); }
@@ -1,15 +1,45 @@
 #include "PerformanceTracker.hpp"
+#include "structures/Data/CuckooHashMap.hpp"
 #include "structures/Data/ExternHashMap.hpp"
 #include "structures/Data/OpenHashMap.hpp"
+#include "structures/Data/RobinHoodHashMap.hpp"
+#include "structures/Trees/AdaptiveRadixTree.hpp"
 #include "structures/Trees/AVLTree.hpp"
+#include "structures/Trees/BPlusTree.hpp"
+#include "structures/Trees/ConcurrentBPlusTree.hpp"
+#include "structures/Trees/PersistentAVLTree.hpp"
 #include "structures/Trees/RedBlack.hpp"
+#include "structures/Trees/SplayTree.hpp"
+#include "structures/Trees/Treap.hpp"
+#include "structures/Trees/WAVLTree.hpp"
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iomanip>
+#include <mutex>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 
+// A sequential tree behind one global mutex: the baseline the concurrent
+// tree is measured against.
+template <typename TreeType> class MutexGuarded {
+public:
+  void insert(const std::pair<std::string, int> &value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tree.insert(value);
+  }
+  bool contains(const std::pair<std::string, int> &value) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tree.contains(value);
+  }
+
+private:
+  TreeType m_tree;
+  std::mutex m_mutex;
+};
+
 class Benchmark {
 private:
   struct TestResult {
@@ -121,6 +151,202 @@ public:
     PERF_TRACKER.printStats();
   }
 
+  // Looks up every word of the text in order, as the frequency count does.
+  // Word frequencies are Zipfian, so this measures how deep the hot keys
+  // sit (search_depth / size): self-adjusting trees keep them near the root.
+  // `args` are forwarded to the tree's constructor.
+  template <typename TreeType, typename... Args>
+  void testSkewedAccess(const std::string &tree_name,
+                        const std::vector<std::pair<std::string, int>> &data,
+                        Args... args) {
+    std::cout << "\n=== Testing " << tree_name
+              << " with skewed lookups (size = " << data.size() << ") ==="
+              << std::endl;
+
+    TreeType tree(args...);
+    for (const auto &value : data) {
+      tree.insert(value);
+    }
+
+    PERF_TRACKER.startOperation(tree_name + " - Skewed search " +
+                                std::to_string(data.size()) + " words");
+    for (const auto &value : data) {
+      tree.getNode(value);
+    }
+    PERF_TRACKER.endOperation();
+
+    auto stats = PERF_TRACKER.getStats();
+    results.push_back({tree_name, "Skewed", stats.execution_time_ms,
+                       stats.rotations, stats.key_comparisons,
+                       stats.insertion_fixups, stats.deletion_fixups,
+                       stats.search_depth, stats.nodes_visited,
+                       stats.color_changes, data.size()});
+    PERF_TRACKER.printStats();
+  }
+
+  // Same lookups as testTreeWithStringPairs, answered by the frozen
+  // (Eytzinger) copy of the tree instead of the pointer-based nodes.
+  template <typename TreeType>
+  void testFrozenTree(const std::string &tree_name,
+                      const std::vector<std::pair<std::string, int>> &data) {
+    std::cout << "\n=== Testing " << tree_name
+              << " (frozen) with string pairs (size = " << data.size()
+              << ") ===" << std::endl;
+
+    TreeType tree;
+    for (const auto &value : data) {
+      tree.insert(value);
+    }
+
+    PERF_TRACKER.startOperation(tree_name + " - Freeze " +
+                                std::to_string(data.size()) + " string pairs");
+    auto frozen = tree.freeze();
+    PERF_TRACKER.endOperation();
+
+    auto stats = PERF_TRACKER.getStats();
+    results.push_back({tree_name + " (frozen)", "Freeze",
+                       stats.execution_time_ms, stats.rotations,
+                       stats.key_comparisons, stats.insertion_fixups,
+                       stats.deletion_fixups, stats.search_depth,
+                       stats.nodes_visited, stats.color_changes, data.size()});
+    PERF_TRACKER.printStats();
+
+    auto search_data = data;
+    std::shuffle(search_data.begin(), search_data.end(),
+                 std::mt19937{std::random_device{}()});
+    search_data.resize(std::min(search_data.size(), size_t(100)));
+
+    PERF_TRACKER.startOperation(tree_name + " (frozen) - Search " +
+                                std::to_string(search_data.size()) +
+                                " string pairs");
+    int found_count = 0;
+    for (const auto &value : search_data) {
+      if (frozen.contains(value)) {
+        found_count++;
+      }
+    }
+    PERF_TRACKER.endOperation();
+
+    stats = PERF_TRACKER.getStats();
+    results.push_back({tree_name + " (frozen)", "Search",
+                       stats.execution_time_ms, stats.rotations,
+                       stats.key_comparisons, stats.insertion_fixups,
+                       stats.deletion_fixups, stats.search_depth,
+                       stats.nodes_visited, stats.color_changes,
+                       search_data.size()});
+    PERF_TRACKER.printStats();
+
+    std::cout << "Found " << found_count << " out of " << search_data.size()
+              << " elements" << std::endl;
+  }
+
+  // Inserts the data into a persistent tree, publishing a version every 256
+  // insertions, while `readers` threads keep taking snapshots and looking
+  // up words in them. The readers never block the writer; the insert time
+  // is compared with the plain "Insert" of testTreeWithStringPairs.
+  void testSnapshotReads(const std::string &tree_name,
+                         const std::vector<std::pair<std::string, int>> &data,
+                         unsigned int readers) {
+    std::cout << "\n=== Testing " << tree_name << " with " << readers
+              << " snapshot readers (size = " << data.size() << ") ==="
+              << std::endl;
+
+    PersistentAVLTree<std::pair<std::string, int>> tree;
+    std::atomic<bool> done{false};
+    std::atomic<unsigned long> lookups{0}, found{0};
+    std::vector<std::thread> threads;
+    for (unsigned int r = 0; r < readers; r++) {
+      threads.emplace_back([&, r] {
+        std::mt19937 rng(r);
+        unsigned long localLookups = 0, localFound = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+          auto version = tree.snapshot();
+          for (int i = 0; i < 64; i++, localLookups++)
+            localFound += version.contains(data[rng() % data.size()]);
+        }
+        lookups += localLookups;
+        found += localFound;
+      });
+    }
+
+    PERF_TRACKER.startOperation(tree_name + " - Insert " +
+                                std::to_string(data.size()) +
+                                " string pairs with readers");
+    for (size_t i = 0; i < data.size(); i++) {
+      tree.insert(data[i]);
+      if ((i + 1) % 256 == 0)
+        tree.publish();
+    }
+    tree.publish();
+    PERF_TRACKER.endOperation();
+    done = true;
+    for (auto &thread : threads)
+      thread.join();
+
+    auto stats = PERF_TRACKER.getStats();
+    results.push_back({tree_name, "Insert+Read", stats.execution_time_ms,
+                       stats.rotations, stats.key_comparisons,
+                       stats.insertion_fixups, stats.deletion_fixups,
+                       stats.search_depth, stats.nodes_visited,
+                       stats.color_changes, data.size()});
+    PERF_TRACKER.printStats();
+
+    std::cout << "Readers did " << lookups << " snapshot lookups (" << found
+              << " found) during the insertions" << std::endl;
+  }
+
+  // Shared map, half of the words preloaded, then a fixed number of
+  // operations (90% lookups, 10% insertions of random words of the text)
+  // spread over 1, 2, 4 and 8 threads. Prints the throughput per thread
+  // count; it only grows with the threads on a machine with as many cores.
+  template <typename MapType>
+  void testConcurrentAccess(
+      const std::string &map_name,
+      const std::vector<std::pair<std::string, int>> &data) {
+    const size_t OPERATIONS = 400000;
+    std::cout << "\n=== Testing " << map_name << " with concurrent threads ("
+              << OPERATIONS << " operations, "
+              << std::thread::hardware_concurrency() << " cores) ==="
+              << std::endl;
+
+    for (unsigned int threads : {1u, 2u, 4u, 8u}) {
+      MapType map;
+      for (size_t i = 0; i < data.size(); i += 2)
+        map.insert(data[i]);
+
+      PERF_TRACKER.startOperation(map_name + " - " + std::to_string(threads) +
+                                  " threads");
+      std::vector<std::thread> workers;
+      for (unsigned int t = 0; t < threads; t++) {
+        workers.emplace_back([&map, &data, t, threads, OPERATIONS] {
+          std::mt19937 rng(t);
+          for (size_t i = 0; i < OPERATIONS / threads; i++) {
+            const auto &value = data[rng() % data.size()];
+            if (rng() % 10 == 0)
+              map.insert(value);
+            else
+              map.contains(value);
+          }
+        });
+      }
+      for (auto &worker : workers)
+        worker.join();
+      PERF_TRACKER.endOperation();
+
+      auto stats = PERF_TRACKER.getStats();
+      results.push_back({map_name + " x" + std::to_string(threads),
+                         "Concurrent", stats.execution_time_ms,
+                         stats.rotations, stats.key_comparisons,
+                         stats.insertion_fixups, stats.deletion_fixups,
+                         stats.search_depth, stats.nodes_visited,
+                         stats.color_changes, OPERATIONS});
+      std::cout << threads << " threads: "
+                << static_cast<unsigned long>(
+                       OPERATIONS / std::max(stats.execution_time_ms, 1e-3))
+                << " ops/ms" << std::endl;
+    }
+  }
+
   template <typename HashMapType>
   void testHashMap(const std::string &hashmap_name,
                    const std::vector<std::pair<std::string, int>> &data) {
@@ -230,12 +456,60 @@ public:
           "AVL Tree", subset_data);
       testTreeWithStringPairs<RedBlack<std::pair<std::string, int>>>(
           "RedBlack Tree", subset_data);
+      testTreeWithStringPairs<WAVLTree<std::pair<std::string, int>>>(
+          "WAVL Tree", subset_data);
+      testTreeWithStringPairs<SplayTree<std::pair<std::string, int>>>(
+          "Splay Tree", subset_data);
+      testTreeWithStringPairs<Treap<std::pair<std::string, int>>>(
+          "Treap", subset_data);
+      testTreeWithStringPairs<PersistentAVLTree<std::pair<std::string, int>>>(
+          "Persistent AVL", subset_data);
+      testTreeWithStringPairs<
+          ConcurrentBPlusTree<std::pair<std::string, int>>>("OLC B+ Tree",
+                                                            subset_data);
+      testSnapshotReads("Persistent AVL", subset_data, 2);
+      testTreeWithStringPairs<BPlusTree<std::pair<std::string, int>>>(
+          "B+ Tree", subset_data);
+      testTreeWithStringPairs<
+          AdaptiveRadixTree<std::pair<std::string, int>>>("Adaptive Radix Tree",
+                                                           subset_data);
+      testSkewedAccess<AVLTree<std::pair<std::string, int>>>("AVL Tree",
+                                                             subset_data);
+      testSkewedAccess<RedBlack<std::pair<std::string, int>>>(
+          "RedBlack Tree", subset_data);
+      testSkewedAccess<WAVLTree<std::pair<std::string, int>>>("WAVL Tree",
+                                                              subset_data);
+      testSkewedAccess<SplayTree<std::pair<std::string, int>>>("Splay Tree",
+                                                               subset_data);
+      testSkewedAccess<SplayTree<std::pair<std::string, int>>>(
+          "Semi-splay Tree", subset_data, 4u);
+      testFrozenTree<AVLTree<std::pair<std::string, int>>>("AVL Tree",
+                                                           subset_data);
+      testFrozenTree<RedBlack<std::pair<std::string, int>>>("RedBlack Tree",
+                                                            subset_data);
       testHashMap<OpenHashMap<std::pair<std::string, int>>>("OpenHashMap",
                                                             subset_data);
       testHashMap<ExternHashMap<std::pair<std::string, int>>>("ExternHashMap",
                                                               subset_data);
+      testHashMap<RobinHoodHashMap<std::pair<std::string, int>>>(
+          "RobinHoodHashMap", subset_data);
+      testHashMap<CuckooHashMap<std::pair<std::string, int>>>("CuckooHashMap",
+                                                              subset_data);
+      // Same maps with the standard library hash, against the default
+      // FastHash (wyhash).
+      testHashMap<OpenHashMap<std::pair<std::string, int>,
+                              std::hash<std::string>>>("Open (std::hash)",
+                                                       subset_data);
+      testHashMap<ExternHashMap<std::pair<std::string, int>,
+                                std::hash<std::string>>>("Extern (std::hash)",
+                                                         subset_data);
     }
 
+    testConcurrentAccess<ConcurrentBPlusTree<std::pair<std::string, int>>>(
+        "OLC B+ Tree", string_pair_data);
+    testConcurrentAccess<MutexGuarded<AVLTree<std::pair<std::string, int>>>>(
+        "AVL + mutex", string_pair_data);
+
     generateReport();
   }
 
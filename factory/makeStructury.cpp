@@ -1,13 +1,28 @@
 #include "makeStructury.hpp"
 
 std::unique_ptr<IFreqDS> createStructure(const std::string &type) {
-  if (type == "avl")
-    return std::make_unique<AVLWrapper>();
-  if (type == "rb")
-    return std::make_unique<RBWrapper>();
-  if (type == "open")
-    return std::make_unique<OpenHashWrapper>();
-  if (type == "extern")
-    return std::make_unique<ExternHashWrapper>();
-  return nullptr;
+  std::unique_ptr<IFreqDS> ds;
+  visitStructure(type, [&ds](auto make) { ds = make(); });
+  return ds;
+}
+
+std::unique_ptr<IFreqDS> freezeStructure(IFreqDS &ds) {
+  return std::make_unique<FrozenWrapper>(ds.getOrderedContent());
+}
+
+void saveSnapshot(IFreqDS &ds, const std::string &path) {
+  writeSnapshot(path, ds.getOrderedContent());
+}
+
+std::unique_ptr<IFreqDS> loadSnapshot(const std::string &type,
+                                      const std::string &path) {
+  if (type == "mmap")
+    return std::make_unique<SnapshotWrapper>(path);
+
+  auto ds = createStructure(type);
+  if (ds) {
+    SnapshotView view(path, true);
+    ds->load(view.entries());
+  }
+  return ds;
 }
@@ -1,12 +1,32 @@
 #ifndef MAKE_STRUCTURY_HPP
 #define MAKE_STRUCTURY_HPP
 
+#include "../persistence/Snapshot.hpp"
+#include "../structures/Data/CuckooHashMap.hpp"
 #include "../structures/Data/ExternHashMap.hpp"
+#include "../structures/Data/FastHash.hpp"
 #include "../structures/Data/OpenHashMap.hpp"
+#include "../structures/Data/PrefixKey.hpp"
+#include "../structures/Data/RobinHoodHashMap.hpp"
+#include "../structures/Data/StringInterner.hpp"
+#include "../structures/Trees/AdaptiveRadixTree.hpp"
 #include "../structures/Trees/AVLTree.hpp"
+#include "../structures/Trees/BPlusTree.hpp"
+#include "../structures/Trees/ConcurrentBPlusTree.hpp"
+#include "../structures/Trees/FrozenTree.hpp"
+#include "../structures/Trees/PersistentAVLTree.hpp"
 #include "../structures/Trees/RedBlack.hpp"
+#include "../structures/Trees/SplayTree.hpp"
+#include "../structures/Trees/Treap.hpp"
+#include "../structures/Trees/WAVLTree.hpp"
+#include <algorithm>
+#include <functional>
+#include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -18,10 +38,151 @@ struct IFreqDS {
   getNode(const std::pair<std::string, int> &p) = 0;
   virtual void show() = 0;
   virtual std::vector<std::pair<std::string, int>> getOrderedContent() = 0;
+  virtual void
+  forEach(const std::function<void(const std::pair<std::string, int> &)>
+              &func) = 0;
+
+  // Adds one occurrence of `word`, inserting it with count 1 when absent.
+  virtual void increment(const std::string &word) {
+    std::pair<std::string, int> probe{word, 0};
+    if (contains(probe)) {
+      auto *node = getNode(probe);
+      if (node)
+        node->key.second++;
+    } else {
+      insert({word, 1});
+    }
+  }
+
+  // Adds one occurrence of each word, in order. Structures with batched
+  // upserts override it to overlap the lookups of the whole block.
+  virtual void incrementBatch(const std::vector<std::string> &words) {
+    for (const std::string &word : words)
+      increment(word);
+  }
+
+  // Occurrences of `word`, 0 when absent.
+  virtual int getCount(const std::string &word) {
+    auto *node = getNode({word, 0});
+    return node ? node->key.second : 0;
+  }
+
+  // The k most frequent words starting with `prefix`, by count and then
+  // word. The default scans every entry; the ordered trees override it with
+  // their augmented search.
+  virtual std::vector<std::pair<std::string, int>>
+  topKByPrefix(const std::string &prefix, size_t k) {
+    std::vector<std::pair<std::string, int>> matches;
+    forEach([&](const std::pair<std::string, int> &entry) {
+      if (entry.first.compare(0, prefix.size(), prefix) == 0)
+        matches.push_back(entry);
+    });
+    size_t n = std::min(k, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + n, matches.end(),
+                      [](const auto &a, const auto &b) {
+                        if (a.second != b.second)
+                          return a.second > b.second;
+                        return a.first < b.first;
+                      });
+    matches.resize(n);
+    return matches;
+  }
+
+  // Bulk load of entries sorted by key (a snapshot export). The default
+  // inserts one by one; structures override it with a cheaper build.
+  virtual void load(const std::vector<std::pair<std::string, int>> &sorted) {
+    for (const auto &entry : sorted)
+      insert(entry);
+  }
 };
 
-struct AVLWrapper : IFreqDS {
-  AVLTree<std::pair<std::string, int>> tree;
+// incrementBatch through the structure's upsertBatch.
+template <typename DS>
+void upsert_counts(DS &ds, const std::vector<std::string> &words) {
+  std::vector<std::pair<std::string, int>> entries;
+  entries.reserve(words.size());
+  for (const std::string &word : words)
+    entries.emplace_back(word, 1);
+  ds.upsertBatch(entries, [](std::pair<std::string, int> &stored,
+                             const std::pair<std::string, int> &incoming) {
+    stored.second += incoming.second;
+  });
+}
+
+// Base of the mutable wrappers. Derived is final, so code holding the
+// concrete wrapper (see visitStructure) calls increment/getCount without
+// virtual dispatch, and they reach Derived's getNode/insert through
+// qualified, statically bound calls that can be inlined down to the
+// structure. A single getNode lookup replaces contains + getNode.
+template <typename Derived> struct FreqDSBase : IFreqDS {
+  void increment(const std::string &word) override {
+    Derived &self = static_cast<Derived &>(*this);
+    std::pair<std::string, int> probe{word, 0};
+    if (auto *node = self.Derived::getNode(probe)) {
+      node->key.second++;
+      self.Derived::countChanged(node);
+    } else {
+      self.Derived::insert({word, 1});
+    }
+  }
+
+  // Reports a count changed in place through getNode. The ordered trees
+  // shadow it to keep the maxCount summaries of topKByPrefix.
+  void countChanged(Node<std::pair<std::string, int>> *node) {}
+
+  int getCount(const std::string &word) override {
+    auto *node = static_cast<Derived &>(*this).Derived::getNode({word, 0});
+    return node ? node->key.second : 0;
+  }
+};
+
+// What a wrapped structure offers beyond the DataStructure interface; the
+// wrappers below use each part only where the structure has it.
+template <typename DS, typename = void>
+struct has_count_summary : std::false_type {};
+template <typename DS>
+struct has_count_summary<
+    DS, std::void_t<decltype(std::declval<DS &>().countChanged(
+            std::declval<Node<std::pair<std::string, int>> *>()))>>
+    : std::true_type {};
+
+template <typename DS, typename = void>
+struct has_prefix_top_k : std::false_type {};
+template <typename DS>
+struct has_prefix_top_k<
+    DS, std::void_t<decltype(std::declval<DS &>().topKByPrefix(
+            std::declval<const std::string &>(), 0))>>
+    : std::true_type {};
+
+template <typename DS, typename = void>
+struct has_upsert_batch : std::false_type {};
+template <typename DS>
+struct has_upsert_batch<
+    DS, std::void_t<decltype(std::declval<DS &>().upsertBatch(
+            std::declval<const std::vector<std::pair<std::string, int>> &>(),
+            std::declval<void (*)(std::pair<std::string, int> &,
+                                  const std::pair<std::string, int> &)>()))>>
+    : std::true_type {};
+
+template <typename DS, typename = void>
+struct has_build_from_sorted : std::false_type {};
+template <typename DS>
+struct has_build_from_sorted<
+    DS, std::void_t<decltype(std::declval<DS &>().buildFromSorted(
+            std::declval<const std::vector<std::pair<std::string, int>> &>()))>>
+    : std::true_type {};
+
+// Wrapper of an ordered structure whose nodes keep their address: the
+// balanced and self-adjusting trees, the B+ tree and the radix tree.
+// Constructor arguments go to the tree (e.g. the splay period). Counts
+// changed in place, batched upserts, the prefix top-k search and the bulk
+// build are forwarded when the tree has them.
+template <typename DS> struct TreeWrapper final : FreqDSBase<TreeWrapper<DS>> {
+  DS tree;
+
+  template <typename... Args>
+  explicit TreeWrapper(Args &&...args) : tree(std::forward<Args>(args)...) {}
+
   void insert(const std::pair<std::string, int> &p) override { tree.insert(p); }
   bool contains(const std::pair<std::string, int> &p) const override {
     return tree.contains(p);
@@ -30,14 +191,121 @@ struct AVLWrapper : IFreqDS {
   getNode(const std::pair<std::string, int> &p) override {
     return tree.getNode(p);
   }
+  void countChanged(Node<std::pair<std::string, int>> *node) {
+    if constexpr (has_count_summary<DS>::value)
+      tree.countChanged(node);
+  }
+  void show() override { tree.show(); }
+  std::vector<std::pair<std::string, int>> getOrderedContent() override {
+    return tree.getOrderedContent();
+  }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    tree.forEach(func);
+  }
+  void incrementBatch(const std::vector<std::string> &words) override {
+    if constexpr (has_upsert_batch<DS>::value)
+      upsert_counts(tree, words);
+    else
+      IFreqDS::incrementBatch(words);
+  }
+  std::vector<std::pair<std::string, int>>
+  topKByPrefix(const std::string &prefix, size_t k) override {
+    if constexpr (has_prefix_top_k<DS>::value)
+      return tree.topKByPrefix(prefix, k);
+    else
+      return IFreqDS::topKByPrefix(prefix, k);
+  }
+  void load(const std::vector<std::pair<std::string, int>> &sorted) override {
+    if constexpr (has_build_from_sorted<DS>::value)
+      tree.buildFromSorted(sorted);
+    else
+      IFreqDS::load(sorted);
+  }
+};
+
+// Wrapper of a hash table. Constructor arguments go to the table (size, load
+// factor and, for the open and extern tables, the RehashMode). Its entries
+// move on rehash, which layoutVersion() reports when the table tracks it.
+template <typename Map> struct MapWrapper final : FreqDSBase<MapWrapper<Map>> {
+  Map map;
+
+  template <typename... Args>
+  explicit MapWrapper(Args &&...args) : map(std::forward<Args>(args)...) {}
+
+  void insert(const std::pair<std::string, int> &p) override { map.insert(p); }
+  bool contains(const std::pair<std::string, int> &p) const override {
+    return map.contains(p);
+  }
+  Node<std::pair<std::string, int>> *
+  getNode(const std::pair<std::string, int> &p) override {
+    return map.getNode(p);
+  }
+  void show() override { map.show(); }
+  std::vector<std::pair<std::string, int>> getOrderedContent() override {
+    return map.getOrderedContent();
+  }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    map.forEach(func);
+  }
+  void incrementBatch(const std::vector<std::string> &words) override {
+    if constexpr (has_upsert_batch<Map>::value)
+      upsert_counts(map, words);
+    else
+      IFreqDS::incrementBatch(words);
+  }
+  template <typename M = Map>
+  auto layoutVersion() const
+      -> decltype(std::declval<const M &>().layoutVersion()) {
+    return map.layoutVersion();
+  }
+  void load(const std::vector<std::pair<std::string, int>> &sorted) override {
+    map.reserve(sorted.size());
+    for (const auto &entry : sorted)
+      map.insert(entry);
+  }
+};
+
+// The counting itself is single-threaded; the tree lets other threads look
+// words up while it runs. Its stored elements are immutable, so getNode
+// returns nullptr and counts go through upsert and the validated find.
+struct ConcurrentBPlusTreeWrapper final : IFreqDS {
+  ConcurrentBPlusTree<std::pair<std::string, int>> tree;
+  void insert(const std::pair<std::string, int> &p) override { tree.insert(p); }
+  bool contains(const std::pair<std::string, int> &p) const override {
+    return tree.contains(p);
+  }
+  Node<std::pair<std::string, int>> *
+  getNode(const std::pair<std::string, int> &p) override {
+    return nullptr;
+  }
+  void increment(const std::string &word) override {
+    tree.upsert({word, 1}, [](std::pair<std::string, int> &stored,
+                              const std::pair<std::string, int> &incoming) {
+      stored.second += incoming.second;
+    });
+  }
+  int getCount(const std::string &word) override {
+    std::pair<std::string, int> entry;
+    return tree.find({word, 0}, entry) ? entry.second : 0;
+  }
   void show() override { tree.show(); }
   std::vector<std::pair<std::string, int>> getOrderedContent() override {
     return tree.getOrderedContent();
   }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    tree.forEach(func);
+  }
 };
 
-struct RBWrapper : IFreqDS {
-  RedBlack<std::pair<std::string, int>> tree;
+// Read-only dictionary produced by freezeStructure; insert throws and getNode
+// returns nullptr, lookups go through contains and getCount.
+struct FrozenWrapper final : IFreqDS {
+  FrozenTree<std::pair<std::string, int>> tree;
+  explicit FrozenWrapper(const std::vector<std::pair<std::string, int>> &sorted)
+      : tree(sorted) {}
   void insert(const std::pair<std::string, int> &p) override { tree.insert(p); }
   bool contains(const std::pair<std::string, int> &p) const override {
     return tree.contains(p);
@@ -46,44 +314,389 @@ struct RBWrapper : IFreqDS {
   getNode(const std::pair<std::string, int> &p) override {
     return tree.getNode(p);
   }
+  int getCount(const std::string &word) override {
+    std::pair<std::string, int> entry;
+    return tree.find({word, 0}, entry) ? entry.second : 0;
+  }
   void show() override { tree.show(); }
   std::vector<std::pair<std::string, int>> getOrderedContent() override {
     return tree.getOrderedContent();
   }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    tree.forEach(func);
+  }
 };
 
-struct OpenHashWrapper : IFreqDS {
-  OpenHashMap<std::pair<std::string, int>> map;
-  void insert(const std::pair<std::string, int> &p) override { map.insert(p); }
+// Read-only dictionary served straight from a memory-mapped snapshot, with no
+// copy of the keys; insert throws and getNode returns nullptr, lookups go
+// through contains and getCount.
+struct SnapshotWrapper final : IFreqDS {
+  SnapshotView view;
+  explicit SnapshotWrapper(const std::string &path) : view(path) {}
+  void insert(const std::pair<std::string, int> &p) override {
+    throw std::logic_error("Snapshot view is read-only");
+  }
   bool contains(const std::pair<std::string, int> &p) const override {
-    return map.contains(p);
+    return view.find(p.first) != SnapshotView::npos;
   }
   Node<std::pair<std::string, int>> *
   getNode(const std::pair<std::string, int> &p) override {
-    return map.getNode(p);
+    return nullptr;
+  }
+  int getCount(const std::string &word) override {
+    size_t i = view.find(word);
+    return i == SnapshotView::npos ? 0 : view.count(i);
+  }
+  void show() override {
+    for (size_t i = 0; i < view.size(); i++)
+      std::cout << "(" << view.key(i) << ", " << view.count(i) << ")\n";
   }
-  void show() override { map.show(); }
   std::vector<std::pair<std::string, int>> getOrderedContent() override {
-    return map.getOrderedContent();
+    return view.entries();
+  }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    for (size_t i = 0; i < view.size(); i++)
+      func({std::string(view.key(i)), view.count(i)});
   }
 };
 
-struct ExternHashWrapper : IFreqDS {
-  ExternHashMap<std::pair<std::string, int>> map;
-  void insert(const std::pair<std::string, int> &p) override { map.insert(p); }
+// Dictionary whose keys live in a StringInterner: the structure stores
+// 16-byte InternedString handles instead of std::strings, so each distinct
+// word costs one arena copy and comparisons mostly stop at the pointer.
+// Key may be any type built from an InternedString (e.g. PrefixKey). Its
+// nodes do not hold std::string keys, so getNode returns nullptr and counts
+// go through increment/getCount.
+template <typename Structure, typename Key = InternedString>
+struct InternedWrapper final : IFreqDS {
+  using Entry = std::pair<Key, int>;
+
+  StringInterner interner;
+  Structure ds;
+
+  void insert(const std::pair<std::string, int> &p) override {
+    ds.insert({Key(interner.intern(p.first)), p.second});
+  }
   bool contains(const std::pair<std::string, int> &p) const override {
-    return map.contains(p);
+    InternedString key = interner.find(p.first);
+    return key.valid() && ds.contains({Key(key), 0});
   }
   Node<std::pair<std::string, int>> *
   getNode(const std::pair<std::string, int> &p) override {
-    return map.getNode(p);
+    return nullptr;
   }
-  void show() override { map.show(); }
+  void increment(const std::string &word) override {
+    Entry probe{Key(interner.intern(word)), 0};
+    if (Node<Entry> *node = ds.getNode(probe))
+      node->key.second++;
+    else
+      ds.insert({probe.first, 1});
+  }
+  int getCount(const std::string &word) override {
+    InternedString key = interner.find(word);
+    if (!key.valid())
+      return 0;
+    Node<Entry> *node = ds.getNode({Key(key), 0});
+    return node ? node->key.second : 0;
+  }
+  void show() override { ds.show(); }
   std::vector<std::pair<std::string, int>> getOrderedContent() override {
-    return map.getOrderedContent();
+    return ds.getOrderedContent();
+  }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    ds.forEach([&func](const Entry &entry) {
+      func({std::string(entry.first), entry.second});
+    });
+  }
+};
+
+// Path-copying AVL tree. Each block of words is published as a new version,
+// so readers holding a snapshot() see a consistent dictionary while the
+// count goes on. Its nodes are immutable once published, so getNode returns
+// nullptr and increments go through upsert.
+struct PersistentAVLWrapper final : IFreqDS {
+  PersistentAVLTree<std::pair<std::string, int>> tree;
+
+  void insert(const std::pair<std::string, int> &p) override {
+    tree.insert(p);
+  }
+  bool contains(const std::pair<std::string, int> &p) const override {
+    return tree.contains(p);
+  }
+  Node<std::pair<std::string, int>> *
+  getNode(const std::pair<std::string, int> &p) override {
+    return nullptr;
+  }
+  void increment(const std::string &word) override {
+    tree.upsert({word, 1}, [](std::pair<std::string, int> &stored,
+                              const std::pair<std::string, int> &incoming) {
+      stored.second += incoming.second;
+    });
+  }
+  void incrementBatch(const std::vector<std::string> &words) override {
+    for (const std::string &word : words)
+      increment(word);
+    tree.publish();
+  }
+  int getCount(const std::string &word) override {
+    const auto *entry = tree.find({word, 0});
+    return entry ? entry->second : 0;
+  }
+  void show() override { tree.show(); }
+  std::vector<std::pair<std::string, int>> getOrderedContent() override {
+    return tree.getOrderedContent();
+  }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    tree.forEach(func);
+  }
+  void load(const std::vector<std::pair<std::string, int>> &sorted) override {
+    tree.buildFromSorted(sorted);
+    tree.publish();
+  }
+};
+
+// Whether a wrapper's nodes keep their address while other keys are
+// inserted: true for the pointer-based trees, the radix tree's leaves and
+// the B+ tree, whose leaves only point at heap nodes; false for the hash
+// tables, whose entries move on rehash.
+template <typename W> struct stable_nodes : std::false_type {};
+template <typename DS>
+struct stable_nodes<TreeWrapper<DS>> : std::true_type {};
+
+// Wrappers whose structure reports when its nodes move (layoutVersion()),
+// e.g. on rehash or incremental migration, even during a lookup.
+template <typename W, typename = void>
+struct has_layout_version : std::false_type {};
+template <typename W>
+struct has_layout_version<
+    W, std::void_t<decltype(std::declval<const W &>().layoutVersion())>>
+    : std::true_type {};
+
+// Small 2-way set-associative cache of recently counted words in front of a
+// wrapper's getNode. Stop words take most of the occurrences of a text, so
+// most increments hit the cache and skip the lookup in the structure.
+// Replacement is frequency-aware: a new word evicts the way whose node has
+// the smaller count, so a run of rare words cannot push out "de" or "que".
+//
+// Entries hold node pointers. A generation counter invalidates all of them
+// at once: it is bumped by load, when the layoutVersion() of the wrapper
+// changes, and otherwise by every insert unless the wrapper's nodes are
+// stable_nodes. A count bumped through a cached node is reported to the
+// wrapper's countChanged, as FreqDSBase::increment does. Hits and misses go
+// to PERF_TRACKER.
+template <typename W> struct FrontCache final : IFreqDS {
+  static constexpr size_t SETS = 256;
+
+  std::unique_ptr<W> inner;
+
+  explicit FrontCache(std::unique_ptr<W> wrapped) : inner(std::move(wrapped)) {}
+
+  void insert(const std::pair<std::string, int> &p) override {
+    inner->insert(p);
+    if constexpr (has_layout_version<W>::value)
+      _sync();
+    else if constexpr (!stable_nodes<W>::value)
+      m_generation++;
+  }
+  bool contains(const std::pair<std::string, int> &p) const override {
+    return inner->contains(p);
+  }
+  Node<std::pair<std::string, int>> *
+  getNode(const std::pair<std::string, int> &p) override {
+    return _lookup(p.first);
+  }
+  void increment(const std::string &word) override {
+    if (auto *node = _lookup(word)) {
+      node->key.second++;
+      inner->countChanged(node);
+    } else {
+      insert({word, 1});
+    }
+  }
+  int getCount(const std::string &word) override {
+    auto *node = _lookup(word);
+    return node ? node->key.second : 0;
+  }
+  void show() override { inner->show(); }
+  std::vector<std::pair<std::string, int>> getOrderedContent() override {
+    return inner->getOrderedContent();
+  }
+  void forEach(const std::function<void(const std::pair<std::string, int> &)>
+                   &func) override {
+    inner->forEach(func);
+  }
+  std::vector<std::pair<std::string, int>>
+  topKByPrefix(const std::string &prefix, size_t k) override {
+    return inner->topKByPrefix(prefix, k);
+  }
+  void load(const std::vector<std::pair<std::string, int>> &sorted) override {
+    inner->load(sorted);
+    m_generation++;
+  }
+
+private:
+  using Entry = Node<std::pair<std::string, int>>;
+
+  struct Way {
+    std::string word;
+    Entry *node{nullptr};
+    size_t generation{0};
+  };
+  struct Set {
+    Way ways[2];
+  };
+
+  std::vector<Set> m_sets = std::vector<Set>(SETS);
+  size_t m_generation{1};
+  size_t m_layout_version{0};
+  FastHash<std::string> m_hash;
+
+  void _sync() {
+    if constexpr (has_layout_version<W>::value) {
+      size_t version = inner->layoutVersion();
+      if (version != m_layout_version) {
+        m_layout_version = version;
+        m_generation++;
+      }
+    }
+  }
+
+  Entry *_lookup(const std::string &word) {
+    _sync();
+    Set &set = m_sets[m_hash(word) & (SETS - 1)];
+    for (Way &way : set.ways) {
+      if (way.generation == m_generation && way.word == word) {
+        PERF_TRACKER.incrementCacheHits();
+        return way.node;
+      }
+    }
+
+    PERF_TRACKER.incrementCacheMisses();
+    Entry *node = inner->getNode({word, 0});
+    _sync();
+    if (node) {
+      Way &victim = _victim(set);
+      victim.word = word;
+      victim.node = node;
+      victim.generation = m_generation;
+    }
+    return node;
+  }
+
+  // An invalid way if there is one, otherwise the less frequent word.
+  Way &_victim(Set &set) {
+    Way &first = set.ways[0];
+    Way &second = set.ways[1];
+    if (first.generation != m_generation)
+      return first;
+    if (second.generation != m_generation)
+      return second;
+    return second.node->key.second < first.node->key.second ? second : first;
   }
 };
 
+// A name accepted by visitStructure and the maker of its wrapper.
+template <typename Make> struct StructureEntry {
+  const char *name;
+  Make make;
+};
+
+// The entry `name` whose maker builds a W from copies of args.
+template <typename W, typename... Args>
+auto structure_entry(const char *name, Args... args) {
+  auto make = [args...] { return std::make_unique<W>(args...); };
+  return StructureEntry<decltype(make)>{name, make};
+}
+
+// Every structure, in the order the command line lists and benchmarks them.
+// make() returns a std::unique_ptr to a new wrapper of the structure's
+// (final) type; entries differ in that type, so the table is a tuple.
+inline const auto &structure_table() {
+  using Counted = std::pair<std::string, int>;
+  using Interned = std::pair<InternedString, int>;
+  using Prefixed = std::pair<PrefixKey, int>;
+
+  static const auto table = std::make_tuple(
+      structure_entry<TreeWrapper<AVLTree<Counted>>>("avl"),
+      structure_entry<TreeWrapper<RedBlack<Counted>>>("rb"),
+      structure_entry<TreeWrapper<WAVLTree<Counted>>>("wavl"),
+      structure_entry<TreeWrapper<SplayTree<Counted>>>("splay"),
+      // Semi-splay: one access in 4 restructures the tree.
+      structure_entry<TreeWrapper<SplayTree<Counted>>>("semisplay", 4),
+      structure_entry<TreeWrapper<Treap<Counted>>>("treap"),
+      structure_entry<TreeWrapper<BPlusTree<Counted>>>("btree"),
+      structure_entry<ConcurrentBPlusTreeWrapper>("btree-olc"),
+      structure_entry<MapWrapper<OpenHashMap<Counted>>>("open"),
+      structure_entry<MapWrapper<ExternHashMap<Counted>>>("extern"),
+      structure_entry<MapWrapper<RobinHoodHashMap<Counted>>>("robin"),
+      structure_entry<MapWrapper<CuckooHashMap<Counted>>>("cuckoo"),
+      structure_entry<TreeWrapper<AdaptiveRadixTree<Counted>>>("art"),
+      structure_entry<InternedWrapper<AVLTree<Interned>>>("avl-intern"),
+      structure_entry<InternedWrapper<RedBlack<Interned>>>("rb-intern"),
+      structure_entry<InternedWrapper<OpenHashMap<Interned>>>("open-intern"),
+      structure_entry<InternedWrapper<ExternHashMap<Interned>>>(
+          "extern-intern"),
+      structure_entry<InternedWrapper<AVLTree<Prefixed>, PrefixKey>>(
+          "avl-prefix"),
+      structure_entry<InternedWrapper<RedBlack<Prefixed>, PrefixKey>>(
+          "rb-prefix"),
+      structure_entry<MapWrapper<OpenHashMap<Counted>>>(
+          "open-inc", 19, 0.75, INCREMENTAL),
+      structure_entry<MapWrapper<ExternHashMap<Counted>>>(
+          "extern-inc", 19, 1.0, INCREMENTAL),
+      structure_entry<PersistentAVLWrapper>("avl-persistent"));
+  return table;
+}
+
+// The names of structure_table, in its order.
+inline const std::vector<std::string> STRUCTURE_NAMES = std::apply(
+    [](const auto &...entry) {
+      return std::vector<std::string>{entry.name...};
+    },
+    structure_table());
+
+// Maps a structure name to its concrete wrapper type. Calls func(make) with
+// the maker of the matching structure_table entry, so a generic func is
+// instantiated once per structure and its hot loop calls the wrapper
+// directly. Returns false, without calling func, for an unknown name.
+// createStructure is this with the result erased to IFreqDS.
+template <typename Func>
+bool visitStructure(const std::string &type, Func &&func) {
+  return std::apply(
+      [&](const auto &...entry) {
+        return ((type == entry.name && (func(entry.make), true)) || ...);
+      },
+      structure_table());
+}
+
+// visitStructure with the wrapper behind a FrontCache (freq --cache). The
+// interned wrappers have no std::string nodes to cache and are passed
+// through unchanged.
+template <typename Func>
+bool visitCachedStructure(const std::string &type, Func &&func) {
+  return visitStructure(type, [&func](auto make) {
+    using W = typename decltype(make())::element_type;
+    if constexpr (std::is_base_of_v<FreqDSBase<W>, W>)
+      func([make] { return std::make_unique<FrontCache<W>>(make()); });
+    else
+      func(make);
+  });
+}
+
 std::unique_ptr<IFreqDS> createStructure(const std::string &type);
+std::unique_ptr<IFreqDS> freezeStructure(IFreqDS &ds);
+
+// Snapshot persistence. loadSnapshot maps the file directly for type "mmap"
+// and bulk loads it into createStructure(type) otherwise; it returns nullptr
+// for an unknown type and throws std::runtime_error for a bad file. The
+// mapping is opened without the full checksum pass, so a corrupt entry is
+// only reported (by the same exception) when a lookup reads it; a bulk load
+// reads every entry anyway and verifies the checksum first.
+void saveSnapshot(IFreqDS &ds, const std::string &path);
+std::unique_ptr<IFreqDS> loadSnapshot(const std::string &type,
+                                      const std::string &path);
 
 #endif
@@ -4,6 +4,7 @@
 
 #include "KeyExtractor.hpp"
 #include "Node.hpp"
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -11,6 +12,8 @@ template <typename T> class DataStructure {
   using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
 
 public:
+  using Visitor = std::function<void(const T &)>;
+
   virtual void insert(T value) = 0;
   virtual void remove(T value) = 0;
   virtual bool contains(T k) const = 0;
@@ -22,6 +25,10 @@ public:
   virtual std::vector<std::pair<std::string, int>>
   getOrderedContent() const = 0;
 
+  // Visits every element once, in whatever order is cheapest for the
+  // structure, without materializing a copy.
+  virtual void forEach(const Visitor &func) const = 0;
+
   template <typename Structure>
   static void execute(Structure &structure,
                       const std::vector<std::string> &words) {
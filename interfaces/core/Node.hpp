@@ -2,10 +2,22 @@
 #define NODE_HPP
 
 #include "../enum/NodeColor.hpp"
+#include <utility>
 #include <vector>
+
+// Count an element contributes to Node::maxCount: the count of a
+// pair<key, count>, nothing for any other element.
+template <typename T> int element_count(const T &) { return 0; }
+template <typename K> int element_count(const std::pair<K, int> &element) {
+  return element.second;
+}
+
 template <typename T> struct Node {
   T key;
   unsigned int height{1};
+  unsigned int size{1}; // nodes in the subtree rooted here (order statistics).
+  int maxCount{element_count(key)}; // largest count in the subtree.
+  unsigned int priority{0}; // heap order of a Treap.
   Node<T> *left{nullptr};
   Node<T> *right{nullptr};
   Node<T> *parent{nullptr};
@@ -13,29 +25,25 @@ template <typename T> struct Node {
   bool leaf{true};
 
   // for binary
-  Node(T key) : key(key) {};
-  Node(T key, Node<T> *left) : key(key), left(left) {};
+  Node(T key) : key(std::move(key)) {};
+  Node(T key, Node<T> *left) : key(std::move(key)), left(left) {};
   Node(T key, Node<T> *left, Node<T> *right)
-      : key(key), left(left), right(right) {};
+      : key(std::move(key)), left(left), right(right) {};
 
   // for RedBlack
-  Node(T key, NodeColor color) : key(key), color(color) {};
+  Node(T key, NodeColor color) : key(std::move(key)), color(color) {};
   Node(T key, Node<T> *parent, NodeColor color)
-      : key(key), parent(parent), color(color) {};
+      : key(std::move(key)), parent(parent), color(color) {};
   Node(T key, Node<T> *left, Node<T> *right, Node<T> *parent, NodeColor color)
-      : key(key), left(left), right(right), parent(parent), color(color) {};
+      : key(std::move(key)), left(left), right(right), parent(parent),
+        color(color) {};
 
   // for AVL
   Node(T key, Node<T> *left, Node<T> *right, Node<T> *parent)
-      : key(key), left(left), right(right), parent(parent) {};
+      : key(std::move(key)), left(left), right(right), parent(parent) {};
 
   // destructor.
   ~Node() {};
 };
 
-// template <typename T> struct BNode {
-//   Node<T> node{nullptr};
-//   std::vector<BNode<T>> childrens{vector<BNode<T>>()};
-// };
-//
 #endif // !NODE_HPP
@@ -1,11 +1,27 @@
 #ifndef SORTED_NAVIGABLE_HPP
 #define SORTED_NAVIGABLE_HPP
 
+#include <functional>
+
 template <typename T> class SortedNavigable {
+public:
+  using RangeCallback = std::function<void(const T &)>;
+
   virtual T minimum() = 0;
   virtual T maximum() = 0;
   virtual T successor(T value) = 0;
   virtual T predecessor(T value) = 0;
+
+  // Order statistics: rank is the number of keys strictly smaller than the
+  // key of `value`, select is the k-th smallest element (0-based).
+  virtual int rank(T value) = 0;
+  virtual T select(int k) = 0;
+
+  // Range queries over the closed interval [lo, hi], compared by key.
+  virtual int countRange(T lo, T hi) = 0;
+  virtual void forEachInRange(T lo, T hi, const RangeCallback &func) = 0;
+
+  virtual ~SortedNavigable() = default;
 };
 
 #endif
@@ -0,0 +1,9 @@
+#ifndef REHASH_MODE_HPP
+#define REHASH_MODE_HPP
+
+// How a hash map grows once its load factor is exceeded: STOP_THE_WORLD moves
+// every element during the triggering insert, INCREMENTAL keeps the previous
+// table alongside the new one and migrates a bounded slice per update.
+enum RehashMode { STOP_THE_WORLD, INCREMENTAL };
+
+#endif
@@ -2,11 +2,15 @@
 #define PRIORITYQUEUE_HPP
 
 #include "../core/DataStructure.hpp"
-#include "../core/Node.hpp"
+#include <cstddef>
+
 template <typename T> class PriorityQueue : public DataStructure<T> {
 public:
   virtual ~PriorityQueue() {};
-  virtual Node<T> *top() = 0;
+  virtual const T &top() const = 0;
+  virtual void push(T value) = 0;
+  virtual void pop() = 0;
+  virtual size_t size() const = 0;
 };
 
 #endif
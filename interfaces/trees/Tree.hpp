@@ -1,17 +1,27 @@
 #ifndef TREE_HPP
 #define TREE_HPP
 
+#include "../../PerformanceTracker.hpp"
+#include "../../structures/Data/Iterator.hpp"
 #include "../core/DataStructure.hpp"
 #include "../core/Node.hpp"
 #include "../core/SortedNavigable.hpp"
+#include <algorithm>
 #include <functional>
 #include <iostream>
+#include <queue>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 template <typename T>
 class Tree : public DataStructure<T>, public SortedNavigable<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+
 public:
   using Callback = std::function<void(Node<T> *)>;
+  using typename SortedNavigable<T>::RangeCallback;
+  using typename DataStructure<T>::Visitor;
 
   virtual Node<T> *getRoot() const = 0;
   virtual Node<T> *&getRootRef() = 0;
@@ -28,6 +38,10 @@ public:
   virtual void in_order(const Callback &func) const {
     inOrder(getRoot(), func);
   }
+  virtual void forEach(const Visitor &func) const override {
+    in_order([&func](Node<T> *node) { func(node->key); });
+  }
+
   virtual void pre_order(const Callback &func) const {
     preOrder(getRoot(), func);
   }
@@ -40,6 +54,205 @@ public:
     reversePreOrder(getRoot(), func);
   }
 
+  // Order statistics and range queries, all driven by the subtree sizes the
+  // implementations keep in Node<T>::size, so each one is O(log n) (plus the
+  // output size for forEachInRange).
+  virtual int rank(T value) override {
+    return countBelow(getRoot(), KeyExtractor<T>::getKey(value), false);
+  }
+
+  virtual T select(int k) override {
+    Node<T> *node = getRoot();
+    if (k < 0 || !node || k >= static_cast<int>(node->size))
+      throw std::out_of_range("Rank out of range");
+
+    while (node) {
+      int leftSize = node->left ? node->left->size : 0;
+      if (k < leftSize) {
+        node = node->left;
+      } else if (k == leftSize) {
+        return node->key;
+      } else {
+        k -= leftSize + 1;
+        node = node->right;
+      }
+    }
+
+    throw std::logic_error("Subtree sizes are inconsistent");
+  }
+
+  virtual int countRange(T lo, T hi) override {
+    const KeyType &loKey = KeyExtractor<T>::getKey(lo);
+    const KeyType &hiKey = KeyExtractor<T>::getKey(hi);
+    if (hiKey < loKey)
+      return 0;
+
+    return countBelow(getRoot(), hiKey, true) -
+           countBelow(getRoot(), loKey, false);
+  }
+
+  virtual void forEachInRange(T lo, T hi, const RangeCallback &func) override {
+    inRange(getRoot(), KeyExtractor<T>::getKey(lo), KeyExtractor<T>::getKey(hi),
+            func);
+  }
+
+  // Keys starting with `prefix`, in order: O(log n) to reach the first match,
+  // then O(1) amortized per key.
+  IteratorRange<TreeIterator<T>> prefixRange(const std::string &prefix) const {
+    Node<T> *first = nullptr;
+    for (Node<T> *node = getRoot(); node;) {
+      if (key_view(KeyExtractor<T>::getKey(node->key)) < prefix) {
+        node = node->right;
+      } else {
+        first = node;
+        node = node->left;
+      }
+    }
+    return {TreeIterator<T>(first, prefix), TreeIterator<T>()};
+  }
+
+  // The k entries with the highest count among the keys starting with
+  // `prefix`, by count and then key (pair<key, count> elements only). The
+  // matches are covered by O(log n) subtrees that are expanded best-first on
+  // Node<T>::maxCount, so only O(log n + k) subtrees are opened however many
+  // keys match. maxCount is kept by insertions, removals and rotations; a
+  // count changed in place must be reported with countChanged (or made
+  // through addCount).
+  std::vector<T> topKByPrefix(const std::string &prefix, size_t k) {
+    auto matches = [&prefix](Node<T> *node) {
+      return has_prefix(key_view(KeyExtractor<T>::getKey(node->key)), prefix);
+    };
+
+    Node<T> *split = getRoot();
+    while (split && !matches(split))
+      split = key_view(KeyExtractor<T>::getKey(split->key)) < prefix
+                  ? split->right
+                  : split->left;
+
+    std::vector<T> result;
+    if (!split || k == 0)
+      return result;
+
+    std::priority_queue<RankedNode, std::vector<RankedNode>, RankedBelow>
+        candidates;
+    auto pushNode = [&candidates](Node<T> *node) {
+      candidates.push({node, node->key.second, false});
+    };
+    auto pushSubtree = [&candidates](Node<T> *node) {
+      if (node)
+        candidates.push({node, node->maxCount, true});
+    };
+
+    // Below the split node every match on the left spine has only matches
+    // to its right, and symmetrically on the right spine.
+    pushNode(split);
+    for (Node<T> *node = split->left; node;) {
+      if (matches(node)) {
+        pushNode(node);
+        pushSubtree(node->right);
+        node = node->left;
+      } else {
+        node = node->right;
+      }
+    }
+    for (Node<T> *node = split->right; node;) {
+      if (matches(node)) {
+        pushNode(node);
+        pushSubtree(node->left);
+        node = node->right;
+      } else {
+        node = node->left;
+      }
+    }
+
+    while (result.size() < k && !candidates.empty()) {
+      RankedNode best = candidates.top();
+      candidates.pop();
+      PERF_TRACKER.incrementNodesVisited();
+      if (!best.subtree) {
+        result.push_back(best.node->key);
+        continue;
+      }
+      pushNode(best.node);
+      pushSubtree(best.node->left);
+      pushSubtree(best.node->right);
+    }
+    return result;
+  }
+
+  // Adds `delta` to the count of the stored entry with the key of `value`
+  // and returns its node, or nullptr when the key is absent.
+  Node<T> *addCount(const T &value, int delta) {
+    Node<T> *node = this->getNode(value);
+    if (node) {
+      node->key.second += delta;
+      countChanged(node);
+    }
+    return node;
+  }
+
+  // Restores maxCount on the path from `node` to the root after the count
+  // stored in it changed in place. Ancestors only depend on their children's
+  // maxCount, so the walk stops at the first node whose summary holds.
+  static void countChanged(Node<T> *node) {
+    for (; node; node = node->parent) {
+      int best = element_count(node->key);
+      if (node->left)
+        best = std::max(best, node->left->maxCount);
+      if (node->right)
+        best = std::max(best, node->right->maxCount);
+      if (best == node->maxCount)
+        return;
+      node->maxCount = best;
+    }
+  }
+
+  // Batched lookups and upserts. The descents of BATCH keys are interleaved
+  // one level at a time and the next node of each is prefetched, so the
+  // cache misses of independent keys overlap instead of being paid one
+  // after another. Results match the one-at-a-time calls in order.
+  void containsBatch(const std::vector<T> &values,
+                     std::vector<bool> &out) const {
+    out.assign(values.size(), false);
+    Node<T> *found[BATCH];
+    for (size_t base = 0; base < values.size(); base += BATCH) {
+      size_t count = std::min(BATCH, values.size() - base);
+      findGroup(getRoot(), &values[base], count, found);
+      for (size_t i = 0; i < count; i++)
+        out[base + i] = found[i] != nullptr;
+    }
+  }
+
+  void insertBatch(const std::vector<T> &values) {
+    upsertBatch(values, [](T &, const T &) {});
+  }
+
+  // Inserts each absent value; for a key already present (including one
+  // inserted earlier in the same batch) calls merge(stored, value) instead.
+  // Insertions only relink nodes, so the hits found for a group stay valid
+  // while its misses are inserted. A miss goes straight to insert unless its
+  // key matches an earlier miss of the same group, which has just inserted
+  // it; only then is it looked up again.
+  template <typename Merge>
+  void upsertBatch(const std::vector<T> &values, Merge merge) {
+    Node<T> *found[BATCH];
+    for (size_t base = 0; base < values.size(); base += BATCH) {
+      size_t count = std::min(BATCH, values.size() - base);
+      findGroup(getRoot(), &values[base], count, found);
+      for (size_t i = 0; i < count; i++) {
+        const T &value = values[base + i];
+        Node<T> *node = found[i];
+        if (!node && _missed_earlier(&values[base], found, i))
+          node = findKey(getRoot(), KeyExtractor<T>::getKey(value));
+        if (node) {
+          merge(node->key, value);
+          countChanged(node);
+        } else
+          this->insert(value);
+      }
+    }
+  }
+
   // I removes all these code in all trees because are the same code to all
   // implementations of this interface, i'm thinking if now this is a
   // interface..
@@ -99,6 +312,85 @@ public:
     func(node);
   }
 
+  static Node<T> *findKey(Node<T> *node, const KeyType &key) {
+    while (node) {
+      PERF_TRACKER.incrementComparisons();
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key == nodeKey)
+        return node;
+      node = key < nodeKey ? node->left : node->right;
+    }
+    return nullptr;
+  }
+
+  // Looks up `count` keys at once, advancing every unfinished descent by one
+  // level per round; found[i] is the node holding values[i], or nullptr.
+  static void findGroup(Node<T> *root, const T *values, size_t count,
+                        Node<T> **found) {
+    Node<T> *cursor[BATCH];
+    for (size_t i = 0; i < count; i++) {
+      cursor[i] = root;
+      found[i] = nullptr;
+    }
+
+    for (bool active = root != nullptr; active;) {
+      active = false;
+      for (size_t i = 0; i < count; i++) {
+        Node<T> *node = cursor[i];
+        if (!node)
+          continue;
+        PERF_TRACKER.incrementComparisons();
+        PERF_TRACKER.incrementNodesVisited();
+        PERF_TRACKER.incrementSearchDepth();
+        const KeyType &key = KeyExtractor<T>::getKey(values[i]);
+        const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+        if (key == nodeKey) {
+          found[i] = node;
+          cursor[i] = nullptr;
+          continue;
+        }
+        node = key < nodeKey ? node->left : node->right;
+        if (node) {
+          __builtin_prefetch(node);
+          active = true;
+        }
+        cursor[i] = node;
+      }
+    }
+  }
+
+  // Number of keys smaller than `key` (or smaller or equal, if `inclusive`).
+  static int countBelow(Node<T> *node, const KeyType &key, bool inclusive) {
+    int count = 0;
+    while (node) {
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      bool goRight = inclusive ? !(key < nodeKey) : nodeKey < key;
+      if (goRight) {
+        count += (node->left ? node->left->size : 0) + 1;
+        node = node->right;
+      } else {
+        node = node->left;
+      }
+    }
+    return count;
+  }
+
+  static void inRange(Node<T> *node, const KeyType &lo, const KeyType &hi,
+                      const RangeCallback &func) {
+    if (!node)
+      return;
+
+    const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+    if (lo < nodeKey)
+      inRange(node->left, lo, hi, func);
+    if (!(nodeKey < lo) && !(hi < nodeKey))
+      func(node->key);
+    if (nodeKey < hi)
+      inRange(node->right, lo, hi, func);
+  }
+
   static void reversePreOrder(Node<T> *node, const Callback &func) {
     if (!node)
       return;
@@ -106,6 +398,42 @@ public:
     reversePreOrder(node->right, func);
     reversePreOrder(node->left, func);
   }
+
+private:
+  // Keys whose descents are interleaved by the batched operations.
+  static constexpr size_t BATCH = 16;
+
+  // Whether the key of group[i] is also the key of an earlier miss in the
+  // group, compared against the batch itself instead of descending again.
+  static bool _missed_earlier(const T *group, Node<T> *const *found,
+                              size_t i) {
+    const KeyType &key = KeyExtractor<T>::getKey(group[i]);
+    for (size_t j = 0; j < i; j++) {
+      if (!found[j] && KeyExtractor<T>::getKey(group[j]) == key)
+        return true;
+    }
+    return false;
+  }
+
+  // A single node ranked by its count, or a whole subtree ranked by its
+  // maxCount. At equal rank subtrees are opened first, so equal counts come
+  // out in key order.
+  struct RankedNode {
+    Node<T> *node;
+    int rank;
+    bool subtree;
+  };
+
+  struct RankedBelow {
+    bool operator()(const RankedNode &a, const RankedNode &b) const {
+      if (a.rank != b.rank)
+        return a.rank < b.rank;
+      if (a.subtree != b.subtree)
+        return b.subtree;
+      return KeyExtractor<T>::getKey(b.node->key) <
+             KeyExtractor<T>::getKey(a.node->key);
+    }
+  };
 };
 
 #endif
@@ -2,14 +2,59 @@
 #define FIXUP_CONTEXT_HPP
 
 #include "../../core/Node.hpp"
-#include <functional>
 
-template <typename CaseType, typename T> class FixupContext {
+#include <type_traits>
+#include <utility>
+
+// Static (CRTP) interface of the rebalancing contexts. A context derives from
+// FixupContext<Self, CaseType, T> and defines, without `virtual`:
+//   CaseType getCase() const;  // which case applies to the current node
+//   Node<T> *useCaseAction();  // the structural step (e.g. linking a node)
+//   Node<T> *fixupAction();    // rebalancing, a switch over getCase()
+// Trees hold contexts by their concrete type and drive them through run(),
+// so every case handler is resolved at compile time and inlined into the
+// tree's insert/remove instead of going through a vtable.
+template <typename Derived, typename CaseType, typename T> class FixupContext {
 public:
-  virtual ~FixupContext() = default;
-  virtual CaseType getCase() const = 0;
-  virtual Node<T> *useCaseAction() = 0;
-  virtual Node<T> *fixupAction() = 0; // Always should return a leaf.
+  using Case = CaseType;
+
+  // The structural step, then the rebalancing; returns what fixupAction
+  // returns.
+  Node<T> *run() {
+    return run([] {});
+  }
+
+  // As run(), calling between() after the structural step, for bookkeeping
+  // the fixup relies on (e.g. subtree sizes along the new node's path).
+  template <typename Step> Node<T> *run(Step between) {
+    derived().useCaseAction();
+    between();
+    return derived().fixupAction();
+  }
+
+protected:
+  // Checked here, where Derived is complete, whenever a context is built.
+  FixupContext() {
+    static_assert(std::is_base_of_v<FixupContext, Derived>,
+                  "FixupContext: Derived must derive from FixupContext");
+    static_assert(
+        std::is_same_v<decltype(std::declval<const Derived &>().getCase()),
+                       CaseType>,
+        "FixupContext: Derived must define CaseType getCase() const");
+    static_assert(
+        std::is_same_v<decltype(std::declval<Derived &>().useCaseAction()),
+                       Node<T> *>,
+        "FixupContext: Derived must define Node<T> *useCaseAction()");
+    static_assert(
+        std::is_same_v<decltype(std::declval<Derived &>().fixupAction()),
+                       Node<T> *>,
+        "FixupContext: Derived must define Node<T> *fixupAction()");
+  }
+  // Contexts live on the stack and are never destroyed through the base.
+  ~FixupContext() = default;
+
+  Derived &derived() { return static_cast<Derived &>(*this); }
+  const Derived &derived() const { return static_cast<const Derived &>(*this); }
 };
 
 #endif
@@ -11,15 +11,15 @@ public:
   ~RotatableTree() = default;
 
 protected:
-  Node<T> *_rotate_left(Node<T> *node) {
-    return RotationCtx<T>::rotate(node, this->getRootRef(), Direction::LEFT);
+  // The tree passes its own root slot, so rebalancing never goes through the
+  // virtual getRootRef().
+  static Node<T> *_rotate_left(Node<T> *node, Node<T> *&root) {
+    return RotationCtx<T>::rotate(node, root, Direction::LEFT);
   }
 
-  Node<T> *_rotate_right(Node<T> *node) {
-    return RotationCtx<T>::rotate(node, this->getRootRef(), Direction::RIGHT);
+  static Node<T> *_rotate_right(Node<T> *node, Node<T> *&root) {
+    return RotationCtx<T>::rotate(node, root, Direction::RIGHT);
   }
 };
 
-;
-
 #endif
@@ -1,8 +1,12 @@
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <unicode/normalizer2.h>
@@ -11,6 +15,7 @@
 
 #include "PerformanceTracker.hpp"
 #include "factory/makeStructury.hpp"
+#include "structures/Data/BinaryHeap.hpp"
 
 std::string normalizeAndRemoveAccents(const std::string &word) {
   UErrorCode status = U_ZERO_ERROR;
@@ -61,20 +66,70 @@ std::vector<size_t> generateLim(size_t total) {
   return lims;
 }
 
-void generateSortedOutputs(const std::string &structType,
-                           const std::string &filename) {
-  std::ifstream input(filename);
-  if (!input) {
-    std::cerr << "Erro ao reabrir o arquivo para gerar ordenação final.\n";
-    return;
-  }
+// Options for the final report. With top == 0 every word is written, ranked by
+// count; otherwise only the `top` most frequent words are kept, and the
+// alphabetical listing is produced only when asked for. A non-empty
+// snapshotPath also saves the dictionary as a binary snapshot, and
+// completePrefix prints the most frequent words starting with `prefix`.
+struct ReportOptions {
+  size_t top = 0;
+  bool alphabetical = true;
+  std::string snapshotPath;
+  bool completePrefix = false;
+  std::string prefix;
+};
+
+// True when `a` comes before `b` in the report: higher count first, ties
+// broken alphabetically so the output is deterministic.
+bool ranksBefore(const std::pair<std::string, int> &a,
+                 const std::pair<std::string, int> &b) {
+  if (a.second != b.second)
+    return a.second > b.second;
+  return a.first < b.first;
+}
 
-  auto ds = createStructure(structType);
-  if (!ds) {
-    std::cerr << "Tipo de estrutura inválido: " << structType << "\n";
-    return;
+// Bounded selection of the `k` highest-ranked words in a single pass over the
+// structure: the heap keeps the current top k with the weakest on top, so each
+// element costs one comparison unless it displaces that weakest candidate.
+std::vector<std::pair<std::string, int>> selectTopWords(IFreqDS &ds, size_t k) {
+  using WordCount = std::pair<std::string, int>;
+  auto byRank = [](const WordCount &a, const WordCount &b) {
+    return ranksBefore(a, b);
+  };
+  BinaryHeap<WordCount, decltype(byRank)> heap(byRank);
+
+  ds.forEach([&](const WordCount &entry) {
+    if (heap.size() < k)
+      heap.push(entry);
+    else if (ranksBefore(entry, heap.top()))
+      heap.replaceTop(entry);
+  });
+
+  std::vector<WordCount> top(heap.elements().begin(), heap.elements().end());
+  std::sort(top.begin(), top.end(), ranksBefore);
+  return top;
+}
+
+void writeWordCounts(const std::string &path,
+                     const std::vector<std::pair<std::string, int>> &words) {
+  std::ofstream output(path);
+  for (const auto &pair : words) {
+    output << pair.first << " " << pair.second << "\n";
   }
+  output.close();
+  std::cout << "📄 Arquivo " << path << " gerado com sucesso.\n";
+}
 
+// Words handed to incrementBatch at a time, so structures with batched
+// upserts can overlap the lookups of independent words.
+const size_t WORD_BLOCK = 256;
+
+// Templated on the dictionary so the per-block call reaches a concrete
+// (final) wrapper directly when it has one; IFreqDS works too, through the
+// vtable.
+template <typename DS> void countWords(DS &ds, std::istream &input) {
+  std::vector<std::string> block;
+  block.reserve(WORD_BLOCK);
   std::string word;
   while (input >> word) {
     std::string cleaned = normalizeAndRemoveAccents(word);
@@ -84,45 +139,168 @@ void generateSortedOutputs(const std::string &structType,
                                  }),
                   cleaned.end());
 
-    if (!cleaned.empty()) {
-      std::pair<std::string, int> probe{cleaned, 0};
-      if (ds->contains(probe)) {
-        auto *node = ds->getNode(probe);
-        if (node)
-          node->key.second++;
-      } else {
-        ds->insert({cleaned, 1});
-      }
+    if (cleaned.empty())
+      continue;
+    block.push_back(std::move(cleaned));
+    if (block.size() == WORD_BLOCK) {
+      ds.incrementBatch(block);
+      block.clear();
     }
   }
+  ds.incrementBatch(block);
+}
+
+void writeReports(IFreqDS &ds, const ReportOptions &options) {
+  if (!options.snapshotPath.empty()) {
+    try {
+      saveSnapshot(ds, options.snapshotPath);
+      std::cout << "💾 Snapshot " << options.snapshotPath
+                << " gerado com sucesso.\n";
+    } catch (const std::exception &e) {
+      std::cerr << "Erro ao salvar snapshot: " << e.what() << "\n";
+    }
+  }
+
+  if (options.completePrefix) {
+    size_t k = options.top > 0 ? options.top : 10;
+    std::cout << "🔎 Palavras mais frequentes com prefixo \""
+              << options.prefix << "\":\n";
+    for (const auto &pair : ds.topKByPrefix(options.prefix, k))
+      std::cout << "  " << pair.first << " " << pair.second << "\n";
+  }
 
-  auto ordered = ds->getOrderedContent();
+  if (options.top > 0) {
+    writeWordCounts("palavras_ordenadas_por_chamadas.txt",
+                    selectTopWords(ds, options.top));
+    if (options.alphabetical)
+      writeWordCounts("palavras_ordenadas_por_letra.txt",
+                      ds.getOrderedContent());
+    return;
+  }
+
+  // getOrderedContent is already sorted by key, so the alphabetical listing
+  // is written first and a single stable sort yields the ranking.
+  auto ordered = ds.getOrderedContent();
+  if (options.alphabetical)
+    writeWordCounts("palavras_ordenadas_por_letra.txt", ordered);
 
-  std::sort(ordered.begin(), ordered.end(),
-            [](const auto &a, const auto &b) { return a.second > b.second; });
+  std::stable_sort(
+      ordered.begin(), ordered.end(),
+      [](const auto &a, const auto &b) { return a.second > b.second; });
+  writeWordCounts("palavras_ordenadas_por_chamadas.txt", ordered);
+}
+
+// visitStructure, or visitCachedStructure when counting with --cache.
+template <typename Func>
+bool visitDictionary(const std::string &type, bool cached, Func &&func) {
+  return cached ? visitCachedStructure(type, func)
+                : visitStructure(type, func);
+}
 
-  std::ofstream byNumberOfShowns("palavras_ordenadas_por_chamadas.txt");
-  for (const auto &pair : ordered) {
-    byNumberOfShowns << pair.first << " " << pair.second << "\n";
+void generateSortedOutputs(const std::string &structType,
+                           const std::string &filename,
+                           const ReportOptions &options, bool cached) {
+  std::ifstream input(filename);
+  if (!input) {
+    std::cerr << "Erro ao reabrir o arquivo para gerar ordenação final.\n";
+    return;
   }
-  byNumberOfShowns.close();
-  std::cout
-      << "📄 Arquivo palavras_ordenadas_por_chamadas.txt gerado com sucesso.\n";
 
-  std::sort(ordered.begin(), ordered.end(),
-            [](const auto &a, const auto &b) { return a.first < b.first; });
+  bool known = visitDictionary(structType, cached, [&](auto make) {
+    auto ds = make();
+    countWords(*ds, input);
+    writeReports(*ds, options);
+  });
+  if (!known)
+    std::cerr << "Tipo de estrutura inválido: " << structType << "\n";
+}
 
-  std::ofstream alfhabeticalOrder("palavras_ordenadas_por_letra.txt");
-  for (const auto &pair : ordered) {
-    alfhabeticalOrder << pair.first << " " << pair.second << "\n";
+// Rebuilds a dictionary from a snapshot instead of re-tokenizing the corpus.
+int loadAndReport(const std::string &structType, const std::string &path,
+                  const ReportOptions &options) {
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<IFreqDS> ds;
+  try {
+    ds = loadSnapshot(structType, path);
+  } catch (const std::exception &e) {
+    std::cerr << "Erro ao carregar snapshot: " << e.what() << "\n";
+    return 1;
   }
-  alfhabeticalOrder.close();
-  std::cout
-      << "📄 Arquivo palavras_ordenadas_por_letra.txt gerado com sucesso.\n";
+  if (!ds) {
+    std::cerr << "Tipo de estrutura inválido: " << structType << "\n";
+    return 1;
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << "📦 Snapshot " << path << " carregado em " << elapsed.count()
+            << " ms (" << structType << ").\n";
+
+  // A mapped snapshot only finds a corrupt entry when it reads it.
+  try {
+    writeReports(*ds, options);
+  } catch (const std::exception &e) {
+    std::cerr << "Erro ao ler snapshot: " << e.what() << "\n";
+    return 1;
+  }
+  return 0;
 }
 
-void runBenchmark(const std::string &structType, const std::string &filename,
-                  size_t total_palavras, std::ofstream &csv_file) {
+// STRUCTURE_NAMES joined by `separator`, the last two by `last`.
+std::string joinStructureNames(const std::string &separator,
+                               const std::string &last) {
+  std::string joined;
+  for (size_t i = 0; i < STRUCTURE_NAMES.size(); i++) {
+    if (i > 0)
+      joined += i + 1 == STRUCTURE_NAMES.size() ? last : separator;
+    joined += STRUCTURE_NAMES[i];
+  }
+  return joined;
+}
+
+// Adds the words of `filename` to the counts stored in `snapshotPath` and
+// writes the merged dictionary back as a new snapshot (to options.snapshotPath
+// when --save is given, otherwise over the original, atomically).
+int updateSnapshot(const std::string &structType,
+                   const std::string &snapshotPath, const std::string &filename,
+                   ReportOptions options) {
+  if (structType == "mmap") {
+    std::cerr << "A estrutura mmap é somente leitura; use "
+              << joinStructureNames(", ", " ou ") << " com --update.\n";
+    return 1;
+  }
+
+  std::ifstream input(filename);
+  if (!input) {
+    std::cerr << "Arquivo vazio ou não pôde ser lido.\n";
+    return 1;
+  }
+
+  std::unique_ptr<IFreqDS> ds;
+  try {
+    ds = loadSnapshot(structType, snapshotPath);
+  } catch (const std::exception &e) {
+    std::cerr << "Erro ao carregar snapshot: " << e.what() << "\n";
+    return 1;
+  }
+  if (!ds) {
+    std::cerr << "Tipo de estrutura inválido: " << structType << "\n";
+    return 1;
+  }
+
+  countWords(*ds, input);
+
+  if (options.snapshotPath.empty())
+    options.snapshotPath = snapshotPath;
+  writeReports(*ds, options);
+  return 0;
+}
+
+// Benchmark loop for one concrete wrapper type; make() builds an empty
+// dictionary for each input size.
+template <typename Make>
+void runBenchmarkWith(Make make, const std::string &structType,
+                      const std::string &filename, size_t total_palavras,
+                      std::ofstream &csv_file) {
   std::vector<size_t> word_limits = generateLim(total_palavras);
 
   for (size_t limit : word_limits) {
@@ -132,15 +310,13 @@ void runBenchmark(const std::string &structType, const std::string &filename,
       break;
     }
 
-    auto ds = createStructure(structType);
-    if (!ds) {
-      std::cerr << "Tipo de estrutura inválido: " << structType << "\n";
-      return;
-    }
+    auto ds = make();
 
     PERF_TRACKER.startOperation(structType + "_freq_" + std::to_string(limit));
 
     size_t word_count = 0;
+    std::vector<std::string> block;
+    block.reserve(WORD_BLOCK);
     std::string word;
     while (input >> word && word_count < limit) {
       std::string cleaned = normalizeAndRemoveAccents(word);
@@ -151,17 +327,15 @@ void runBenchmark(const std::string &structType, const std::string &filename,
                     cleaned.end());
 
       if (!cleaned.empty()) {
-        std::pair<std::string, int> probe{cleaned, 0};
-        if (ds->contains(probe)) {
-          auto *node = ds->getNode(probe);
-          if (node)
-            node->key.second++;
-        } else {
-          ds->insert({cleaned, 1});
-        }
+        block.push_back(std::move(cleaned));
         ++word_count;
+        if (block.size() == WORD_BLOCK) {
+          ds->incrementBatch(block);
+          block.clear();
+        }
       }
     }
+    ds->incrementBatch(block);
 
     PERF_TRACKER.endOperation();
     auto stats = PERF_TRACKER.getStats();
@@ -178,23 +352,123 @@ void runBenchmark(const std::string &structType, const std::string &filename,
     writeStatsCSV(structType, limit, stats);
 
     std::cout << "✔ Benchmark com " << limit << " palavras (" << structType
-              << ") finalizado.\n";
+              << ") finalizado";
+    if (stats.cache_hits + stats.cache_misses > 0)
+      std::cout << " (cache: " << stats.cache_hits << " acertos, "
+                << stats.cache_misses << " faltas)";
+    std::cout << ".\n";
   }
 }
 
+// With a front cache the rows are labeled "<estrutura>-cache".
+void runBenchmark(const std::string &structType, const std::string &filename,
+                  size_t total_palavras, std::ofstream &csv_file,
+                  bool cached) {
+  std::string label = cached ? structType + "-cache" : structType;
+  bool known = visitDictionary(structType, cached, [&](auto make) {
+    runBenchmarkWith(make, label, filename, total_palavras, csv_file);
+  });
+  if (!known)
+    std::cerr << "Tipo de estrutura inválido: " << structType << "\n";
+}
+
+void printUsage(const char *program) {
+  std::string names = joinStructureNames("|", "|");
+  std::cerr << "Uso: " << program << " freq <" << names
+            << "|--benchmark> "
+               "<arquivo_texto> [--top N] [--alpha] [--prefix P] "
+               "[--save <snapshot.bin>] [--cache]\n"
+            << "       " << program << " freq [" << names
+            << "] "
+               "--update <snapshot.bin> <arquivo_texto> [--top N] [--alpha] "
+               "[--save <snapshot.bin>]\n"
+            << "       " << program << " load <" << names
+            << "|mmap> "
+               "<snapshot.bin> [--top N] [--alpha] [--prefix P]\n";
+}
+
 int main(int argc, char *argv[]) {
-  if (argc != 4) {
-    std::cerr << "Uso: " << argv[0]
-              << " freq <avl|rb|open|extern|--benchmark> <arquivo_texto>\n";
+  std::vector<std::string> positional;
+  ReportOptions options;
+  bool alphaRequested = false;
+  std::string updatePath;
+  bool cached = false;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--top") {
+      if (i + 1 >= argc) {
+        printUsage(argv[0]);
+        return 1;
+      }
+      try {
+        size_t parsed = 0;
+        long long value = std::stoll(argv[++i], &parsed);
+        if (value <= 0 || argv[i][parsed] != '\0')
+          throw std::invalid_argument(argv[i]);
+        options.top = static_cast<size_t>(value);
+      } catch (const std::exception &) {
+        std::cerr << "Valor inválido para --top: " << argv[i] << "\n";
+        return 1;
+      }
+    } else if (arg == "--alpha") {
+      alphaRequested = true;
+    } else if (arg == "--save") {
+      if (i + 1 >= argc) {
+        printUsage(argv[0]);
+        return 1;
+      }
+      options.snapshotPath = argv[++i];
+    } else if (arg == "--prefix") {
+      if (i + 1 >= argc) {
+        printUsage(argv[0]);
+        return 1;
+      }
+      options.completePrefix = true;
+      options.prefix = normalizeAndRemoveAccents(argv[++i]);
+    } else if (arg == "--cache") {
+      cached = true;
+    } else if (arg == "--update") {
+      if (i + 1 >= argc) {
+        printUsage(argv[0]);
+        return 1;
+      }
+      updatePath = argv[++i];
+    } else {
+      positional.push_back(arg);
+    }
+  }
+
+  // A top-N report skips the alphabetical listing unless --alpha is given.
+  if (options.top > 0)
+    options.alphabetical = alphaRequested;
+
+  // freq [estrutura] --update <snapshot> <arquivo>: the structure defaults to
+  // the open-addressing hash map.
+  if (!updatePath.empty()) {
+    if (positional.empty() || positional[0] != "freq" ||
+        positional.size() < 2 || positional.size() > 3) {
+      printUsage(argv[0]);
+      return 1;
+    }
+    std::string structType = positional.size() == 3 ? positional[1] : "open";
+    return updateSnapshot(structType, updatePath, positional.back(), options);
+  }
+
+  if (positional.size() != 3) {
+    printUsage(argv[0]);
     return 1;
   }
 
-  std::string command = argv[1];
-  std::string structType = argv[2];
-  std::string filename = argv[3];
+  std::string command = positional[0];
+  std::string structType = positional[1];
+  std::string filename = positional[2];
+
+  if (command == "load")
+    return loadAndReport(structType, filename, options);
 
   if (command != "freq") {
-    std::cerr << "Comando inválido. Use: freq\n";
+    std::cerr << "Comando inválido. Use: freq ou load\n";
     return 1;
   }
 
@@ -221,13 +495,13 @@ int main(int argc, char *argv[]) {
   };
 
   if (structType == "--benchmark") {
-    for (const std::string type : {"avl", "rb", "open", "extern"}) {
-      runBenchmark(type, filename, total_palavras, csv_file);
+    for (const std::string &type : STRUCTURE_NAMES) {
+      runBenchmark(type, filename, total_palavras, csv_file, cached);
     }
     std::cout << "🏁 Benchmark para todas as estruturas finalizado.\n";
   } else {
-    runBenchmark(structType, filename, total_palavras, csv_file);
-    generateSortedOutputs(structType, filename);
+    runBenchmark(structType, filename, total_palavras, csv_file, cached);
+    generateSortedOutputs(structType, filename, options, cached);
   }
 
   csv_file.close();
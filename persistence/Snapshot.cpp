@@ -0,0 +1,176 @@
+#include "Snapshot.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t fnv1a(const void *data, size_t length,
+                      uint64_t hash = FNV_OFFSET_BASIS) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < length; i++) {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+void writeSnapshot(const std::string &path,
+                   const std::vector<std::pair<std::string, int>> &sorted) {
+  std::vector<uint64_t> offsets;
+  std::vector<uint32_t> counts;
+  std::string chars;
+
+  offsets.reserve(sorted.size() + 1);
+  counts.reserve(sorted.size());
+  offsets.push_back(0);
+  for (const auto &entry : sorted) {
+    chars += entry.first;
+    offsets.push_back(chars.size());
+    counts.push_back(static_cast<uint32_t>(entry.second));
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.byteOrder = SNAPSHOT_BYTE_ORDER;
+  header.count = sorted.size();
+  header.charBytes = chars.size();
+
+  uint64_t checksum = fnv1a(offsets.data(), offsets.size() * sizeof(uint64_t));
+  checksum = fnv1a(counts.data(), counts.size() * sizeof(uint32_t), checksum);
+  header.checksum = fnv1a(chars.data(), chars.size(), checksum);
+
+  // Written next to the target and renamed over it, so readers never observe
+  // a half-written snapshot.
+  std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+      throw std::runtime_error("Cannot create snapshot " + tmpPath);
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(offsets.data()),
+              offsets.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(counts.data()),
+              counts.size() * sizeof(uint32_t));
+    out.write(chars.data(), chars.size());
+    out.flush();
+    if (!out) {
+      std::remove(tmpPath.c_str());
+      throw std::runtime_error("Failed writing snapshot " + tmpPath);
+    }
+  }
+
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    throw std::runtime_error("Cannot replace snapshot " + path);
+  }
+}
+
+SnapshotView::SnapshotView(const std::string &path, bool verify) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Cannot open snapshot " + path);
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0 ||
+      static_cast<size_t>(info.st_size) < sizeof(SnapshotHeader)) {
+    ::close(fd);
+    throw std::runtime_error("Snapshot too small: " + path);
+  }
+
+  m_length = static_cast<size_t>(info.st_size);
+  m_data = ::mmap(nullptr, m_length, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (m_data == MAP_FAILED) {
+    m_data = nullptr;
+    throw std::runtime_error("Cannot map snapshot " + path);
+  }
+
+  auto fail = [&](const std::string &reason) {
+    ::munmap(m_data, m_length);
+    m_data = nullptr;
+    throw std::runtime_error("Invalid snapshot " + path + ": " + reason);
+  };
+
+  const char *base = static_cast<const char *>(m_data);
+  SnapshotHeader header;
+  std::memcpy(&header, base, sizeof(header));
+
+  if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+    fail("bad magic");
+  if (header.version != SNAPSHOT_VERSION)
+    fail("unsupported version " + std::to_string(header.version));
+  if (header.byteOrder != SNAPSHOT_BYTE_ORDER)
+    fail("written with a different byte order");
+
+  size_t payload = m_length - sizeof(SnapshotHeader);
+  if (header.count > payload / (sizeof(uint64_t) + sizeof(uint32_t)))
+    fail("truncated");
+  size_t offsetsBytes = (header.count + 1) * sizeof(uint64_t);
+  size_t countsBytes = header.count * sizeof(uint32_t);
+  if (offsetsBytes + countsBytes > payload ||
+      header.charBytes != payload - offsetsBytes - countsBytes)
+    fail("section sizes do not match the file size");
+
+  const char *body = base + sizeof(SnapshotHeader);
+  m_count = header.count;
+  m_char_bytes = header.charBytes;
+  m_offsets = reinterpret_cast<const uint64_t *>(body);
+  m_counts = reinterpret_cast<const uint32_t *>(body + offsetsBytes);
+  m_chars = body + offsetsBytes + countsBytes;
+
+  if (m_offsets[0] != 0 || m_offsets[m_count] != header.charBytes)
+    fail("corrupt offsets");
+  if (verify) {
+    if (const char *reason = _corruption())
+      fail(reason);
+  }
+}
+
+const char *SnapshotView::_corruption() const {
+  SnapshotHeader header;
+  std::memcpy(&header, m_data, sizeof(header));
+  const char *body = static_cast<const char *>(m_data) + sizeof(header);
+  if (fnv1a(body, m_length - sizeof(header)) != header.checksum)
+    return "checksum mismatch";
+
+  for (size_t i = 0; i < m_count; i++)
+    if (m_offsets[i] > m_offsets[i + 1])
+      return "corrupt offsets";
+  return nullptr;
+}
+
+SnapshotView::~SnapshotView() {
+  if (m_data)
+    ::munmap(m_data, m_length);
+}
+
+size_t SnapshotView::find(std::string_view target) const {
+  size_t lo = 0, hi = m_count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (key(mid) < target)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < m_count && key(lo) == target ? lo : npos;
+}
+
+std::vector<std::pair<std::string, int>> SnapshotView::entries() const {
+  std::vector<std::pair<std::string, int>> result;
+  result.reserve(m_count);
+  for (size_t i = 0; i < m_count; i++)
+    result.emplace_back(std::string(key(i)), count(i));
+  return result;
+}
@@ -0,0 +1,91 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Binary snapshot of a word-frequency dictionary, written in host byte order:
+//
+//   SnapshotHeader (40 bytes)
+//   uint64_t offsets[count + 1]   start of each key in chars, plus the end
+//   uint32_t counts[count]
+//   char     chars[charBytes]     keys packed back to back, no terminators
+//
+// Entries are sorted by key, so the file can be searched in place. The
+// checksum is FNV-1a (64 bits) over everything after the header.
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t count;
+  uint64_t charBytes;
+  uint64_t checksum;
+};
+
+static_assert(sizeof(SnapshotHeader) == 40, "Snapshot header must be packed");
+
+constexpr char SNAPSHOT_MAGIC[8] = {'F', 'R', 'E', 'Q', 'S', 'N', 'A', 'P'};
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+constexpr uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// Writes `sorted` (ordered by key, no duplicates) to `path`. Throws
+// std::runtime_error if the file cannot be written.
+void writeSnapshot(const std::string &path,
+                   const std::vector<std::pair<std::string, int>> &sorted);
+
+// Read-only view of a snapshot file mapped into memory. Opening validates the
+// header and the section sizes against the file size in O(1) and throws
+// std::runtime_error on any mismatch; afterwards keys are served straight
+// from the mapping. The checksum, which takes a pass over the whole file, is
+// only checked with `verify` or by verify(); without it each entry's offsets
+// are bounds-checked as it is read, so a corrupt file still throws
+// std::runtime_error instead of reading outside the mapping.
+class SnapshotView {
+public:
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  explicit SnapshotView(const std::string &path, bool verify = false);
+  ~SnapshotView();
+
+  SnapshotView(const SnapshotView &) = delete;
+  SnapshotView &operator=(const SnapshotView &) = delete;
+
+  size_t size() const { return m_count; }
+
+  std::string_view key(size_t i) const {
+    uint64_t begin = m_offsets[i], end = m_offsets[i + 1];
+    if (begin > end || end > m_char_bytes)
+      throw std::runtime_error("Invalid snapshot: corrupt offsets");
+    return std::string_view(m_chars + begin, end - begin);
+  }
+
+  int count(size_t i) const { return static_cast<int>(m_counts[i]); }
+
+  // Binary search over the sorted keys; npos when absent.
+  size_t find(std::string_view key) const;
+
+  // Copies every entry out, in key order, for bulk loading.
+  std::vector<std::pair<std::string, int>> entries() const;
+
+  // Whether the checksum and the offsets match the data. O(file size).
+  bool verify() const { return _corruption() == nullptr; }
+
+private:
+  void *m_data{nullptr};
+  size_t m_length{0};
+  size_t m_count{0};
+  uint64_t m_char_bytes{0};
+  const uint64_t *m_offsets{nullptr};
+  const uint32_t *m_counts{nullptr};
+  const char *m_chars{nullptr};
+
+  // What the full check finds wrong with the data, nullptr when nothing.
+  const char *_corruption() const;
+};
+
+#endif
@@ -1,27 +1,182 @@
 #ifndef BHEAP_HPP
 #define BHEAP_HPP
-#include "../../interfaces/core/DataStructure.hpp"
 
-// TODO: wee need to implement this DataStructure.
-template <typename T> class BinaryHeap : public DataStructure<T> {
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/KeyExtractor.hpp"
+#include "../../interfaces/structures/PriorityQueue.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Array-backed d-ary heap. Like std::priority_queue, top() is the greatest
+// element according to Compare. With Arity = 4 the children of a node share a
+// cache line for small T and the tree is half as deep as a binary heap, which
+// pays off for sift-down heavy workloads such as bounded top-k selection.
+template <typename T, typename Compare = std::less<T>, size_t Arity = 4>
+class BinaryHeap : public PriorityQueue<T> {
+  static_assert(Arity >= 2, "Heap arity must be at least 2");
 
 public:
-  BinaryHeap() : _elements() {}
+  explicit BinaryHeap(Compare compare = Compare()) : m_compare(compare) {}
+
+  template <typename It>
+  BinaryHeap(It first, It last, Compare compare = Compare())
+      : m_compare(compare) {
+    assign(first, last);
+  }
+
   ~BinaryHeap() {};
 
-  void insert(T value) override { _elements.insert(value); };
-  void remove(T value) override { _elements.remove(value); };
-  T minimum() override { return _elements.minimum(); };
-  T maximum() override { return _elements.maximum(); };
-  T successor(T value) override { return _elements.successor(value); };
-  T predecessor(T value) override { return _elements.predecessor(value); };
-  bool contains(T k) const override { return _elements.contains(k); };
-  bool isEmpty() override { return _elements.isEmpty(); };
-  void show() override { _elements.show(); };
-  void clear() override { _elements.clear(); };
+  // Replaces the content with [first, last) using bottom-up heapify, O(n).
+  template <typename It> void assign(It first, It last) {
+    m_elements.assign(first, last);
+    if (m_elements.size() < 2)
+      return;
+
+    for (size_t i = _parent(m_elements.size() - 1) + 1; i-- > 0;)
+      _sift_down(i);
+  }
+
+  // Priority queue methods
+  const T &top() const override {
+    if (m_elements.empty())
+      throw std::runtime_error("Heap is empty");
+    return m_elements.front();
+  }
+
+  void push(T value) override {
+    m_elements.push_back(std::move(value));
+    _sift_up(m_elements.size() - 1);
+  }
+
+  void pop() override {
+    if (m_elements.empty())
+      throw std::runtime_error("Heap is empty");
+
+    m_elements.front() = std::move(m_elements.back());
+    m_elements.pop_back();
+    if (!m_elements.empty())
+      _sift_down(0);
+  }
+
+  // Pops the top and pushes `value` with a single sift-down.
+  void replaceTop(T value) {
+    if (m_elements.empty())
+      throw std::runtime_error("Heap is empty");
+
+    m_elements.front() = std::move(value);
+    _sift_down(0);
+  }
+
+  size_t size() const override { return m_elements.size(); }
+
+  // Data Structure: methods
+  void insert(T value) override { push(std::move(value)); }
+
+  void remove(T value) override {
+    size_t idx = _find(KeyExtractor<T>::getKey(value));
+    if (idx == m_elements.size())
+      return;
+
+    m_elements[idx] = std::move(m_elements.back());
+    m_elements.pop_back();
+    if (idx < m_elements.size()) {
+      _sift_up(idx);
+      _sift_down(idx);
+    }
+  }
+
+  bool contains(T k) const override {
+    return _find(KeyExtractor<T>::getKey(k)) != m_elements.size();
+  }
+
+  bool isEmpty() override { return m_elements.empty(); }
+
+  void show() override {
+    for (size_t i = 0; i < m_elements.size(); i++)
+      std::cout << "[" << i << "]: " << m_elements[i] << "\n";
+  }
+
+  void clear() override { m_elements.clear(); }
+
+  // Heap elements are not Node<T>s.
+  Node<T> *getNode(const T &value) override { return nullptr; }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result(m_elements.begin(),
+                                                    m_elements.end());
+    std::sort(result.begin(), result.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    return result;
+  }
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (const T &element : m_elements)
+      func(element);
+  }
+
+  // Underlying array in heap order.
+  const std::vector<T> &elements() const { return m_elements; }
 
 private:
-  T _elements;
+  std::vector<T> m_elements;
+  Compare m_compare;
+
+  static size_t _parent(size_t i) { return (i - 1) / Arity; }
+  static size_t _first_child(size_t i) { return Arity * i + 1; }
+
+  bool _less(const T &a, const T &b) const {
+    PERF_TRACKER.incrementComparisons();
+    return m_compare(a, b);
+  }
+
+  template <typename K> size_t _find(const K &key) const {
+    for (size_t i = 0; i < m_elements.size(); i++) {
+      PERF_TRACKER.incrementNodesVisited();
+      if (KeyExtractor<T>::getKey(m_elements[i]) == key)
+        return i;
+    }
+    return m_elements.size();
+  }
+
+  void _sift_up(size_t i) {
+    T value = std::move(m_elements[i]);
+    while (i > 0) {
+      size_t parent = _parent(i);
+      if (!_less(m_elements[parent], value))
+        break;
+      m_elements[i] = std::move(m_elements[parent]);
+      i = parent;
+    }
+    m_elements[i] = std::move(value);
+  }
+
+  void _sift_down(size_t i) {
+    size_t n = m_elements.size();
+    T value = std::move(m_elements[i]);
+
+    while (true) {
+      size_t first = _first_child(i);
+      if (first >= n)
+        break;
+
+      size_t last = std::min(first + Arity, n);
+      size_t best = first;
+      for (size_t c = first + 1; c < last; c++)
+        if (_less(m_elements[best], m_elements[c]))
+          best = c;
+
+      if (!_less(value, m_elements[best]))
+        break;
+      m_elements[i] = std::move(m_elements[best]);
+      i = best;
+    }
+    m_elements[i] = std::move(value);
+  }
 };
 
 #endif
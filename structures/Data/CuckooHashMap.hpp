@@ -0,0 +1,239 @@
+#ifndef CUCKOO_HASHMAP_HPP
+#define CUCKOO_HASHMAP_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/DataStructure.hpp"
+#include "../../interfaces/core/KeyExtractor.hpp"
+#include "../../interfaces/core/Node.hpp"
+#include "FastHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Bucketized cuckoo hashing: every key may live in one of the 4 slots of
+// either of its two candidate buckets. A bucket is exactly one 64-byte cache
+// line holding the slots' full hashes and node pointers, so a lookup reads at
+// most two lines of the table and dereferences a node only when the stored
+// hash matches. Inserting into two full buckets kicks a resident to its other
+// bucket, repeating up to MAX_KICKS times before the table grows.
+// Elements are heap-allocated Node<T>s, so getNode pointers survive growth.
+template <typename T,
+          typename Hash = FastHash<std::decay_t<
+              decltype(KeyExtractor<T>::getKey(std::declval<T>()))>>>
+class CuckooHashMap : public DataStructure<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+
+  static constexpr size_t SLOTS = 4;
+  static constexpr int MAX_KICKS = 500;
+
+  struct alignas(64) Bucket {
+    size_t hashes[SLOTS]{};
+    Node<T> *nodes[SLOTS]{};
+  };
+
+  static_assert(sizeof(Bucket) == 64, "A bucket must fill one cache line");
+
+public:
+  CuckooHashMap(size_t tableSize = 19, float loadFactor = 0.95)
+      : m_bucket_count(next_power_of_two((tableSize + SLOTS - 1) / SLOTS)),
+        m_number_of_elements(0), m_max_load_factor(loadFactor) {
+    m_table.resize(m_bucket_count);
+  }
+
+  CuckooHashMap(const CuckooHashMap &) = delete;
+  CuckooHashMap &operator=(const CuckooHashMap &) = delete;
+
+  ~CuckooHashMap() { _clear(); }
+
+  void insert(T value) override { _insert(value); }
+
+  void remove(T value) override { _remove(KeyExtractor<T>::getKey(value)); }
+
+  bool contains(T k) const override {
+    return _find(KeyExtractor<T>::getKey(k)) != nullptr;
+  }
+
+  bool isEmpty() override { return m_number_of_elements == 0; }
+
+  void show() override {
+    for (size_t i = 0; i < m_bucket_count; i++) {
+      std::cout << "[" << i << "]: ";
+      for (size_t s = 0; s < SLOTS; s++)
+        if (m_table[i].nodes[s])
+          std::cout << "(" << KeyExtractor<T>::getKey(m_table[i].nodes[s]->key)
+                    << ") ";
+      std::cout << "\n";
+    }
+  }
+
+  void clear() override { _clear(); }
+
+  // Presizes the table so `count` elements fit without growing, used when
+  // bulk loading a known number of entries.
+  void reserve(size_t count) {
+    size_t needed = static_cast<size_t>(
+        std::ceil(count / (m_max_load_factor * SLOTS)) + 1);
+    if (needed > m_bucket_count)
+      rehash(needed);
+  }
+
+  Node<T> *getNode(const T &value) override {
+    Node<T> *const *slot = _find(KeyExtractor<T>::getKey(value));
+    return slot ? *slot : nullptr;
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    result.reserve(m_number_of_elements);
+    forEach([&result](const T &value) { result.push_back(value); });
+    std::sort(result.begin(), result.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    return result;
+  }
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (const Bucket &bucket : m_table)
+      for (size_t s = 0; s < SLOTS; s++)
+        if (bucket.nodes[s])
+          func(bucket.nodes[s]->key);
+  }
+
+private:
+  std::vector<Bucket> m_table;
+  size_t m_bucket_count;
+  size_t m_number_of_elements;
+  float m_max_load_factor;
+  Hash m_hash;
+  size_t m_kick_slot{0};
+
+  size_t full_hash(const KeyType &key) const { return mix_hash(m_hash(key)); }
+
+  // The two candidate buckets both derive from the stored hash, so moving a
+  // resident never needs its key rehashed.
+  size_t primary_bucket(size_t hash) const {
+    return hash & (m_bucket_count - 1);
+  }
+  size_t secondary_bucket(size_t hash) const {
+    return mix_hash(hash ^ 0x9e3779b97f4a7c15ULL) & (m_bucket_count - 1);
+  }
+
+  Node<T> *const *_find_in(const Bucket &bucket, const KeyType &key,
+                           size_t hash) const {
+    PERF_TRACKER.incrementNodesVisited();
+    PERF_TRACKER.incrementSearchDepth();
+    for (size_t s = 0; s < SLOTS; s++) {
+      if (bucket.nodes[s] && bucket.hashes[s] == hash) {
+        PERF_TRACKER.incrementComparisons();
+        if (KeyExtractor<T>::getKey(bucket.nodes[s]->key) == key)
+          return &bucket.nodes[s];
+      }
+    }
+    return nullptr;
+  }
+
+  Node<T> *const *_find(const KeyType &key) const {
+    size_t hash = full_hash(key);
+    const Bucket &first = m_table[primary_bucket(hash)];
+    __builtin_prefetch(&m_table[secondary_bucket(hash)]);
+    if (Node<T> *const *slot = _find_in(first, key, hash))
+      return slot;
+    return _find_in(m_table[secondary_bucket(hash)], key, hash);
+  }
+
+  bool _try_store(size_t index, Node<T> *node, size_t hash) {
+    Bucket &bucket = m_table[index];
+    for (size_t s = 0; s < SLOTS; s++) {
+      if (!bucket.nodes[s]) {
+        bucket.nodes[s] = node;
+        bucket.hashes[s] = hash;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Places a node whose key is absent. When both buckets are full, residents
+  // are evicted to their alternate bucket; if the walk does not end in a free
+  // slot the table doubles and the node still being carried is retried.
+  void _place(Node<T> *node, size_t hash) {
+    while (true) {
+      size_t index = primary_bucket(hash);
+      if (_try_store(index, node, hash) ||
+          _try_store(secondary_bucket(hash), node, hash)) {
+        ++m_number_of_elements;
+        return;
+      }
+
+      for (int kick = 0; kick < MAX_KICKS; kick++) {
+        PERF_TRACKER.incrementNodesVisited();
+        Bucket &bucket = m_table[index];
+        size_t s = m_kick_slot++ % SLOTS;
+        std::swap(node, bucket.nodes[s]);
+        std::swap(hash, bucket.hashes[s]);
+
+        size_t primary = primary_bucket(hash);
+        index = index == primary ? secondary_bucket(hash) : primary;
+        if (_try_store(index, node, hash)) {
+          ++m_number_of_elements;
+          return;
+        }
+      }
+
+      rehash(2 * m_bucket_count);
+    }
+  }
+
+  void rehash(size_t new_bucket_count) {
+    new_bucket_count = next_power_of_two(new_bucket_count);
+    std::vector<Bucket> old_table = std::move(m_table);
+
+    m_table.clear();
+    m_table.resize(new_bucket_count);
+    m_bucket_count = new_bucket_count;
+    m_number_of_elements = 0;
+
+    for (const Bucket &bucket : old_table)
+      for (size_t s = 0; s < SLOTS; s++)
+        if (bucket.nodes[s])
+          _place(bucket.nodes[s], bucket.hashes[s]);
+  }
+
+  void _insert(const T &value) {
+    KeyType key = KeyExtractor<T>::getKey(value);
+    if (_find(key))
+      return;
+
+    if (m_number_of_elements + 1 > m_max_load_factor * SLOTS * m_bucket_count)
+      rehash(2 * m_bucket_count);
+
+    _place(new Node<T>(value), full_hash(key));
+  }
+
+  void _remove(const KeyType &key) {
+    Node<T> *const *slot = _find(key);
+    if (!slot)
+      return;
+
+    Node<T> **owned = const_cast<Node<T> **>(slot);
+    delete *owned;
+    *owned = nullptr;
+    --m_number_of_elements;
+  }
+
+  void _clear() {
+    for (Bucket &bucket : m_table) {
+      for (size_t s = 0; s < SLOTS; s++) {
+        delete bucket.nodes[s];
+        bucket.nodes[s] = nullptr;
+      }
+    }
+    m_number_of_elements = 0;
+  }
+};
+
+#endif
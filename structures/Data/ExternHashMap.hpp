@@ -5,24 +5,39 @@
 #include "../../interfaces/core/DataStructure.hpp"
 #include "../../interfaces/core/KeyExtractor.hpp"
 #include "../../interfaces/core/Node.hpp"
+#include "../../interfaces/enum/RehashMode.hpp"
+#include "FastHash.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <iostream>
-#include <queue>
 #include <vector>
 
+// Separate chaining over a power-of-two table. Each bucket is a contiguous
+// vector of entries holding the element's full hash, so lookups skip key
+// compares on hash mismatch and rehashing never calls Hash again.
+//
+// In INCREMENTAL mode growth keeps the previous table and every update moves
+// the next MIGRATION_STEP buckets into the new one; lookups check the new
+// table first and then the key's bucket in the old table.
 template <typename T,
-          typename Hash = std::hash<std::decay_t<
+          typename Hash = FastHash<std::decay_t<
               decltype(KeyExtractor<T>::getKey(std::declval<T>()))>>>
 
 class ExternHashMap : public DataStructure<T> {
   using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
 
+  struct Entry {
+    size_t hash;
+    Node<T> node;
+  };
+
 public:
-  ExternHashMap(size_t tableSize = 19, float loadFactor = 1.0)
-      : m_table_size(get_next_prime(tableSize)), m_number_of_elements(0),
-        m_max_load_factor(loadFactor) {
+  ExternHashMap(size_t tableSize = 19, float loadFactor = 1.0,
+                RehashMode mode = STOP_THE_WORLD)
+      : m_table_size(next_power_of_two(tableSize)), m_number_of_elements(0),
+        m_max_load_factor(loadFactor), m_rehash_mode(mode) {
     m_table.resize(m_table_size);
   }
 
@@ -38,183 +53,279 @@ public:
 
   void show() override {
     for (size_t i = 0; i < m_table_size; i++) {
-      std::queue<T> temp = m_table[i];
       std::cout << "[" << i << "]: ";
-      while (!temp.empty()) {
-        std::cout << "(" << KeyExtractor<T>::getKey(temp.front()) << ") ";
-        temp.pop();
-      }
+      for (const Entry &entry : m_table[i])
+        std::cout << "(" << KeyExtractor<T>::getKey(entry.node.key) << ") ";
+      std::cout << "\n";
+    }
+    for (size_t i = m_migrate_pos; i < m_old_table.size(); i++) {
+      std::cout << "[old " << i << "]: ";
+      for (const Entry &entry : m_old_table[i])
+        std::cout << "(" << KeyExtractor<T>::getKey(entry.node.key) << ") ";
       std::cout << "\n";
     }
   }
 
   void clear() override { _clear(); }
 
+  // Presizes the table so `count` elements fit without intermediate rehashes,
+  // used when bulk loading a known number of entries.
+  void reserve(size_t count) {
+    size_t needed =
+        static_cast<size_t>(std::ceil(count / m_max_load_factor)) + 1;
+    if (needed > m_table_size)
+      rehash(needed);
+  }
+
   Node<T> *getNode(const T &value) override {
-    size_t index = hash_key(KeyExtractor<T>::getKey(value));
-    std::queue<T> &bucket = m_table[index];
-    T *result = nullptr;
-    std::queue<T> temp;
+    _migrate_step();
+    Entry *entry = _find(KeyExtractor<T>::getKey(value));
+    return entry ? &entry->node : nullptr;
+  }
 
-    while (!bucket.empty()) {
-      T &element = bucket.front();
-      PERF_TRACKER.incrementComparisons();
-      PERF_TRACKER.incrementNodesVisited();
-      PERF_TRACKER.incrementSearchDepth();
-      if (KeyExtractor<T>::getKey(element) == KeyExtractor<T>::getKey(value))
-        result = &element;
-      temp.push(std::move(element));
-      bucket.pop();
-    }
+  // Changes whenever stored nodes move (rehash, migration, removal, or a
+  // bucket reallocating on insert), so a pointer from getNode stays valid
+  // while the version is unchanged.
+  size_t layoutVersion() const { return m_layout_version; }
 
-    bucket = std::move(temp);
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    result.reserve(m_number_of_elements);
+    forEach([&result](const T &value) { result.push_back(value); });
+    std::sort(result.begin(), result.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    return result;
+  }
 
-    if (!result)
-      return nullptr;
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (const auto &bucket : m_table)
+      for (const Entry &entry : bucket)
+        func(entry.node.key);
+    for (size_t i = m_migrate_pos; i < m_old_table.size(); i++)
+      for (const Entry &entry : m_old_table[i])
+        func(entry.node.key);
+  }
 
-    return reinterpret_cast<Node<T> *>(result);
+  // Batched operations. A bucket costs two dependent misses, its vector
+  // header and then its entries, so each block of BATCH keys is prefetched
+  // in two passes: all headers first, then the entry arrays they point to.
+  // Results match the one-at-a-time calls in order.
+  void insertBatch(const std::vector<T> &values) {
+    upsertBatch(values, [](T &, const T &) {});
   }
 
-  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
-    std::vector<std::pair<std::string, int>> result;
-    for (const auto &bucket : m_table) {
-      std::queue<T> temp = bucket;
-      while (!temp.empty()) {
-        const T &item = temp.front();
-        result.push_back(item);
-        temp.pop();
+  void containsBatch(const std::vector<T> &values,
+                     std::vector<bool> &out) const {
+    out.assign(values.size(), false);
+    size_t hashes[BATCH];
+    for (size_t base = 0; base < values.size(); base += BATCH) {
+      size_t count = std::min(BATCH, values.size() - base);
+      _prefetch_block(&values[base], count, hashes);
+      for (size_t i = 0; i < count; i++)
+        out[base + i] = _find_in(*this,
+                                 KeyExtractor<T>::getKey(values[base + i]),
+                                 hashes[i]) != nullptr;
+    }
+  }
+
+  // Inserts each absent value; for a key already present (including one
+  // inserted earlier in the same batch) calls merge(stored, value) instead.
+  template <typename Merge>
+  void upsertBatch(const std::vector<T> &values, Merge merge) {
+    size_t hashes[BATCH];
+    for (size_t base = 0; base < values.size(); base += BATCH) {
+      size_t count = std::min(BATCH, values.size() - base);
+      _prefetch_block(&values[base], count, hashes);
+      for (size_t i = 0; i < count; i++) {
+        const T &value = values[base + i];
+        _migrate_step();
+        Entry *entry =
+            _find_in(*this, KeyExtractor<T>::getKey(value), hashes[i]);
+        if (entry)
+          merge(entry->node.key, value);
+        else
+          _insert(value, hashes[i]);
       }
     }
-    std::sort(result.begin(), result.end(),
-              [](const auto &a, const auto &b) { return a.first < b.first; });
-    return result;
   }
 
 private:
-  std::vector<std::queue<T>> m_table;
+  // Old buckets moved per update while an incremental resize runs.
+  static constexpr size_t MIGRATION_STEP = 4;
+  // Keys whose buckets are prefetched together by the batched operations.
+  static constexpr size_t BATCH = 16;
+
+  std::vector<std::vector<Entry>> m_table;
   size_t m_table_size;
   size_t m_number_of_elements;
   float m_max_load_factor;
   Hash m_hash;
 
-  size_t hash_key(const KeyType &key) const {
-    return m_hash(key) % m_table_size;
+  RehashMode m_rehash_mode;
+  // Table being drained by an incremental resize; empty otherwise. Buckets
+  // below m_migrate_pos are already empty.
+  std::vector<std::vector<Entry>> m_old_table;
+  size_t m_migrate_pos{0};
+  size_t m_layout_version{0};
+
+  size_t full_hash(const KeyType &key) const { return mix_hash(m_hash(key)); }
+
+  size_t bucket_index(size_t hash) const { return hash & (m_table_size - 1); }
+
+  template <typename Bucket>
+  static auto _scan(Bucket &bucket, const KeyType &key, size_t hash)
+      -> decltype(&bucket[0]) {
+    for (auto &entry : bucket) {
+      PERF_TRACKER.incrementComparisons();
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      if (entry.hash == hash && KeyExtractor<T>::getKey(entry.node.key) == key)
+        return &entry;
+    }
+    return nullptr;
+  }
+
+  bool migrating() const { return !m_old_table.empty(); }
+
+  size_t old_bucket_index(size_t hash) const {
+    return hash & (m_old_table.size() - 1);
+  }
+
+  template <typename Map>
+  static auto _find_in(Map &map, const KeyType &key)
+      -> decltype(&map.m_table[0][0]) {
+    return _find_in(map, key, map.full_hash(key));
+  }
+
+  template <typename Map>
+  static auto _find_in(Map &map, const KeyType &key, size_t hash)
+      -> decltype(&map.m_table[0][0]) {
+    if (auto *entry = _scan(map.m_table[map.bucket_index(hash)], key, hash))
+      return entry;
+    if (map.migrating())
+      return _scan(map.m_old_table[map.old_bucket_index(hash)], key, hash);
+    return nullptr;
+  }
+
+  Entry *_find(const KeyType &key) { return _find_in(*this, key); }
+  const Entry *_find(const KeyType &key) const { return _find_in(*this, key); }
+
+  void _prefetch_block(const T *values, size_t count, size_t *hashes) const {
+    for (size_t i = 0; i < count; i++) {
+      hashes[i] = full_hash(KeyExtractor<T>::getKey(values[i]));
+      __builtin_prefetch(&m_table[bucket_index(hashes[i])]);
+    }
+    for (size_t i = 0; i < count; i++)
+      __builtin_prefetch(m_table[bucket_index(hashes[i])].data());
+  }
+
+  void _migrate_step(size_t buckets = MIGRATION_STEP) {
+    if (!migrating())
+      return;
+
+    m_layout_version++;
+    size_t end = std::min(m_old_table.size(), m_migrate_pos + buckets);
+    for (; m_migrate_pos < end; m_migrate_pos++) {
+      for (Entry &entry : m_old_table[m_migrate_pos])
+        m_table[bucket_index(entry.hash)].push_back(std::move(entry));
+      std::vector<Entry>().swap(m_old_table[m_migrate_pos]);
+    }
+
+    if (m_migrate_pos == m_old_table.size()) {
+      std::vector<std::vector<Entry>>().swap(m_old_table);
+      m_migrate_pos = 0;
+    }
+  }
+
+  void _finish_migration() { _migrate_step(m_old_table.size()); }
+
+  void _grow() {
+    if (m_rehash_mode == STOP_THE_WORLD) {
+      rehash(2 * m_table_size);
+      return;
+    }
+
+    _finish_migration();
+    m_old_table = std::move(m_table);
+    m_migrate_pos = 0;
+    m_table_size *= 2;
+    m_table.clear();
+    m_table.resize(m_table_size);
   }
 
   void rehash(size_t new_size) {
-    new_size = get_next_prime(new_size);
-    std::vector<std::queue<T>> old_table = std::move(m_table);
+    _finish_migration();
+    m_layout_version++;
+    new_size = next_power_of_two(new_size);
+    std::vector<std::vector<Entry>> old_table = std::move(m_table);
 
     m_table.clear();
     m_table.resize(new_size);
     m_table_size = new_size;
-    m_number_of_elements = 0;
 
-    for (auto &bucket : old_table) {
-      while (!bucket.empty()) {
-        _insert(bucket.front());
-        bucket.pop();
-      }
-    }
+    for (auto &bucket : old_table)
+      for (Entry &entry : bucket)
+        m_table[bucket_index(entry.hash)].push_back(std::move(entry));
   }
 
   void _insert(const T &value) {
+    _migrate_step();
+    _insert(value, full_hash(KeyExtractor<T>::getKey(value)));
+  }
+
+  void _insert(const T &value, size_t hash) {
     if (load_factor() >= m_max_load_factor)
-      rehash(2 * m_table_size);
+      _grow();
 
-    KeyType key = KeyExtractor<T>::getKey(value);
-    size_t index = hash_key(key);
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    std::vector<Entry> &bucket = m_table[bucket_index(hash)];
 
-    std::queue<T> &bucket = m_table[index];
-    bool found = false;
-    std::queue<T> temp;
-    while (!bucket.empty()) {
-      T front = bucket.front();
-      bucket.pop();
-      PERF_TRACKER.incrementComparisons();
-      PERF_TRACKER.incrementNodesVisited();
-      PERF_TRACKER.incrementSearchDepth();
-      if (KeyExtractor<T>::getKey(front) == key)
-        found = true;
-      temp.push(front);
-    }
-    bucket = std::move(temp);
+    if (migrating() && _scan(m_old_table[old_bucket_index(hash)], key, hash))
+      return;
 
-    if (!found) {
-      bucket.push(value);
+    if (!_scan(bucket, key, hash)) {
+      if (!bucket.empty() && bucket.size() == bucket.capacity())
+        m_layout_version++;
+      bucket.push_back(Entry{hash, Node<T>(value)});
       ++m_number_of_elements;
     }
   }
 
-  bool _contains(const KeyType &key) const {
-    size_t index = hash_key(key);
-    std::queue<T> temp = m_table[index];
-    while (!temp.empty()) {
-      T element = temp.front();
-      temp.pop();
-      PERF_TRACKER.incrementComparisons();
-      PERF_TRACKER.incrementNodesVisited();
-      PERF_TRACKER.incrementSearchDepth();
-      if (KeyExtractor<T>::getKey(element) == key)
-        return true;
-    }
-    return false;
-  }
+  bool _contains(const KeyType &key) const { return _find(key) != nullptr; }
 
   void _remove(const KeyType &key) {
-    size_t index = hash_key(key);
-    std::queue<T> &bucket = m_table[index];
-    std::queue<T> temp;
-    bool found = false;
-
-    while (!bucket.empty()) {
-      T element = bucket.front();
-      bucket.pop();
-      PERF_TRACKER.incrementComparisons();
-      PERF_TRACKER.incrementNodesVisited();
-      PERF_TRACKER.incrementSearchDepth();
-      if (KeyExtractor<T>::getKey(element) == key) {
-        found = true;
-        continue;
-      }
-      temp.push(element);
+    _migrate_step();
+    size_t hash = full_hash(key);
+    std::vector<Entry> *owner = &m_table[bucket_index(hash)];
+    Entry *entry = _scan(*owner, key, hash);
+    if (!entry && migrating()) {
+      owner = &m_old_table[old_bucket_index(hash)];
+      entry = _scan(*owner, key, hash);
     }
-
-    bucket = std::move(temp);
-
-    if (found)
-      --m_number_of_elements;
+    if (!entry)
+      return;
+
+    std::vector<Entry> &bucket = *owner;
+    m_layout_version++;
+    // Bucket order is irrelevant, so the last entry fills the hole.
+    if (entry != &bucket.back())
+      *entry = std::move(bucket.back());
+    bucket.pop_back();
+    --m_number_of_elements;
   }
 
   void _clear() {
-    for (auto &q : m_table)
-      std::queue<T>().swap(q);
+    m_layout_version++;
+    for (auto &bucket : m_table)
+      bucket.clear();
+    std::vector<std::vector<Entry>>().swap(m_old_table);
+    m_migrate_pos = 0;
     m_number_of_elements = 0;
   }
 
   float load_factor() const {
     return static_cast<float>(m_number_of_elements) / m_table_size;
   }
-
-  size_t get_next_prime(size_t x) const {
-    if (x <= 2)
-      return 3;
-    if (x % 2 == 0)
-      ++x;
-
-    while (true) {
-      bool is_prime = true;
-      for (size_t i = 3; i * i <= x; i += 2) {
-        if (x % i == 0) {
-          is_prime = false;
-          break;
-        }
-      }
-      if (is_prime)
-        return x;
-      x += 2;
-    }
-  }
 };
 
 #endif // EXTERN_HASHMAP_HPP
@@ -0,0 +1,130 @@
+#ifndef FAST_HASH_HPP
+#define FAST_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Hash functions for the hash maps. The maps reduce hashes with a power-of-two
+// mask, so every hash goes through mix_hash first: it spreads entropy into the
+// low bits, which matters for weak hashes such as the identity std::hash of
+// integers.
+
+// 64-bit finalizer (splitmix64 / murmur3 fmix).
+inline uint64_t mix_hash(uint64_t h) {
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+
+inline uint64_t _wy_mix(uint64_t a, uint64_t b) {
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t _wy_read8(const uint8_t *p) {
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+inline uint64_t _wy_read4(const uint8_t *p) {
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+inline uint64_t _wy_read3(const uint8_t *p, size_t k) {
+  return (static_cast<uint64_t>(p[0]) << 16) |
+         (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+// Smallest power of two >= x (at least 8), for mask-reduced tables.
+inline size_t next_power_of_two(size_t x) {
+  size_t size = 8;
+  while (size < x)
+    size <<= 1;
+  return size;
+}
+
+// wyhash-style hash modelled on wyhash final v4: reads the input 8 or 16
+// bytes at a time and folds it with 64x64->128 bit multiplies. Short keys, the
+// common case for words, take at most four overlapping loads and no loop.
+inline uint64_t wyhash_bytes(const void *key, size_t len, uint64_t seed = 0) {
+  static constexpr uint64_t secret[4] = {
+      0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL,
+      0x589965cc75374cc3ULL};
+
+  const uint8_t *p = static_cast<const uint8_t *>(key);
+  seed ^= _wy_mix(seed ^ secret[0], secret[1]);
+  uint64_t a, b;
+
+  if (len <= 16) {
+    if (len >= 4) {
+      size_t shift = (len >> 3) << 2;
+      a = (_wy_read4(p) << 32) | _wy_read4(p + shift);
+      b = (_wy_read4(p + len - 4) << 32) | _wy_read4(p + len - 4 - shift);
+    } else if (len > 0) {
+      a = _wy_read3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t i = len;
+    if (i > 48) {
+      uint64_t see1 = seed, see2 = seed;
+      do {
+        seed = _wy_mix(_wy_read8(p) ^ secret[1], _wy_read8(p + 8) ^ seed);
+        see1 = _wy_mix(_wy_read8(p + 16) ^ secret[2], _wy_read8(p + 24) ^ see1);
+        see2 = _wy_mix(_wy_read8(p + 32) ^ secret[3], _wy_read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16) {
+      seed = _wy_mix(_wy_read8(p) ^ secret[1], _wy_read8(p + 8) ^ seed);
+      i -= 16;
+      p += 16;
+    }
+    a = _wy_read8(p + i - 16);
+    b = _wy_read8(p + i - 8);
+  }
+
+  a ^= secret[1];
+  b ^= seed;
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+  return _wy_mix(a ^ secret[0] ^ len, b ^ secret[1]);
+}
+
+// Default hasher of the hash maps: wyhash for strings, std::hash plus the
+// finalizer for everything else. Pass std::hash<Key> as the Hash parameter of
+// a map to compare against the standard library.
+template <typename K> struct FastHash {
+  size_t operator()(const K &key) const {
+    return mix_hash(std::hash<K>{}(key));
+  }
+};
+
+template <> struct FastHash<std::string> {
+  size_t operator()(const std::string &key) const {
+    return wyhash_bytes(key.data(), key.size());
+  }
+};
+
+template <> struct FastHash<std::string_view> {
+  size_t operator()(std::string_view key) const {
+    return wyhash_bytes(key.data(), key.size());
+  }
+};
+
+#endif
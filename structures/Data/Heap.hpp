@@ -1,6 +1,176 @@
 #ifndef HEAP_HPP
 #define HEAP_HPP
 
-template <typename T> class Heap {};
+#include "../../PerformanceTracker.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Addressable d-ary heap: push returns a handle that stays valid until the
+// element is popped or erased, so the element can be re-prioritised in
+// O(log_d n) (decrease-key). Elements stay put in m_values; the heap array
+// only moves handles around. Same ordering convention as BinaryHeap: top() is
+// the greatest element according to Compare.
+template <typename T, typename Compare = std::less<T>, size_t Arity = 4>
+class Heap {
+  static_assert(Arity >= 2, "Heap arity must be at least 2");
+  static constexpr size_t NPOS = static_cast<size_t>(-1);
+
+public:
+  using Handle = size_t;
+
+  explicit Heap(Compare compare = Compare()) : m_compare(compare) {}
+
+  // Bulk load with bottom-up heapify, O(n). Handles are assigned in input
+  // order, starting from 0.
+  template <typename It>
+  Heap(It first, It last, Compare compare = Compare()) : m_compare(compare) {
+    for (; first != last; ++first) {
+      m_position.push_back(m_heap.size());
+      m_heap.push_back(m_values.size());
+      m_values.push_back(*first);
+    }
+
+    if (m_heap.size() < 2)
+      return;
+    for (size_t i = _parent(m_heap.size() - 1) + 1; i-- > 0;)
+      _sift_down(i);
+  }
+
+  Handle push(T value) {
+    Handle handle;
+    if (!m_free.empty()) {
+      handle = m_free.back();
+      m_free.pop_back();
+      m_values[handle] = std::move(value);
+    } else {
+      handle = m_values.size();
+      m_values.push_back(std::move(value));
+      m_position.push_back(NPOS);
+    }
+
+    m_position[handle] = m_heap.size();
+    m_heap.push_back(handle);
+    _sift_up(m_heap.size() - 1);
+    return handle;
+  }
+
+  const T &top() const { return m_values[topHandle()]; }
+
+  Handle topHandle() const {
+    if (m_heap.empty())
+      throw std::runtime_error("Heap is empty");
+    return m_heap.front();
+  }
+
+  void pop() { erase(topHandle()); }
+
+  void erase(Handle handle) {
+    size_t pos = _checked_position(handle);
+    _swap(pos, m_heap.size() - 1);
+    m_heap.pop_back();
+    m_position[handle] = NPOS;
+    m_free.push_back(handle);
+
+    if (pos < m_heap.size()) {
+      _sift_up(pos);
+      _sift_down(pos);
+    }
+  }
+
+  // Moves the element towards the top; `value` must not compare lower than
+  // the current one.
+  void decreaseKey(Handle handle, T value) {
+    size_t pos = _checked_position(handle);
+    if (m_compare(value, m_values[handle]))
+      throw std::invalid_argument("decreaseKey would lower the priority");
+    m_values[handle] = std::move(value);
+    _sift_up(pos);
+  }
+
+  // Arbitrary change of priority.
+  void update(Handle handle, T value) {
+    size_t pos = _checked_position(handle);
+    m_values[handle] = std::move(value);
+    _sift_up(pos);
+    _sift_down(m_position[handle]);
+  }
+
+  const T &get(Handle handle) const {
+    _checked_position(handle);
+    return m_values[handle];
+  }
+
+  bool contains(Handle handle) const {
+    return handle < m_position.size() && m_position[handle] != NPOS;
+  }
+
+  size_t size() const { return m_heap.size(); }
+  bool isEmpty() const { return m_heap.empty(); }
+
+  void clear() {
+    m_heap.clear();
+    m_values.clear();
+    m_position.clear();
+    m_free.clear();
+  }
+
+private:
+  std::vector<Handle> m_heap;     // heap order, holds handles
+  std::vector<T> m_values;        // indexed by handle
+  std::vector<size_t> m_position; // handle -> index in m_heap, NPOS if gone
+  std::vector<Handle> m_free;
+  Compare m_compare;
+
+  static size_t _parent(size_t i) { return (i - 1) / Arity; }
+  static size_t _first_child(size_t i) { return Arity * i + 1; }
+
+  size_t _checked_position(Handle handle) const {
+    if (!contains(handle))
+      throw std::out_of_range("Invalid heap handle");
+    return m_position[handle];
+  }
+
+  bool _less(size_t a, size_t b) const {
+    PERF_TRACKER.incrementComparisons();
+    return m_compare(m_values[m_heap[a]], m_values[m_heap[b]]);
+  }
+
+  void _swap(size_t a, size_t b) {
+    std::swap(m_heap[a], m_heap[b]);
+    m_position[m_heap[a]] = a;
+    m_position[m_heap[b]] = b;
+  }
+
+  void _sift_up(size_t i) {
+    while (i > 0 && _less(_parent(i), i)) {
+      _swap(i, _parent(i));
+      i = _parent(i);
+    }
+  }
+
+  void _sift_down(size_t i) {
+    size_t n = m_heap.size();
+    while (true) {
+      size_t first = _first_child(i);
+      if (first >= n)
+        return;
+
+      size_t last = std::min(first + Arity, n);
+      size_t best = first;
+      for (size_t c = first + 1; c < last; c++)
+        if (_less(best, c))
+          best = c;
+
+      if (!_less(i, best))
+        return;
+      _swap(i, best);
+      i = best;
+    }
+  }
+};
 
 #endif
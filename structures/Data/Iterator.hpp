@@ -0,0 +1,105 @@
+#ifndef ITERATOR_HPP
+#define ITERATOR_HPP
+
+#include "../../interfaces/core/KeyExtractor.hpp"
+#include "../../interfaces/core/Node.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Bytes of a dictionary key, for prefix queries. Plain strings are viewed
+// directly; key handles (InternedString, PrefixKey) expose view().
+inline std::string_view key_view(const std::string &key) { return key; }
+
+template <typename K> std::string_view key_view(const K &key) {
+  return key.view();
+}
+
+inline bool has_prefix(std::string_view key, std::string_view prefix) {
+  return key.substr(0, prefix.size()) == prefix;
+}
+
+// In-order forward iterator over a binary search tree with parent links.
+// Keys sharing a prefix are contiguous in key order, so the iterator starts
+// at the first match and turns into the end iterator at the first key that
+// does not start with `prefix` (an empty prefix never stops it). Each step is
+// amortized O(1).
+template <typename T> class TreeIterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const T *;
+  using reference = const T &;
+
+  TreeIterator() = default;
+  TreeIterator(Node<T> *node, std::string prefix)
+      : m_node(node), m_prefix(std::move(prefix)) {
+    _check_prefix();
+  }
+
+  reference operator*() const { return m_node->key; }
+  pointer operator->() const { return &m_node->key; }
+  Node<T> *node() const { return m_node; }
+
+  TreeIterator &operator++() {
+    m_node = _next(m_node);
+    _check_prefix();
+    return *this;
+  }
+
+  TreeIterator operator++(int) {
+    TreeIterator previous = *this;
+    ++*this;
+    return previous;
+  }
+
+  friend bool operator==(const TreeIterator &a, const TreeIterator &b) {
+    return a.m_node == b.m_node;
+  }
+  friend bool operator!=(const TreeIterator &a, const TreeIterator &b) {
+    return a.m_node != b.m_node;
+  }
+
+private:
+  Node<T> *m_node{nullptr};
+  std::string m_prefix;
+
+  static Node<T> *_next(Node<T> *node) {
+    if (node->right) {
+      node = node->right;
+      while (node->left)
+        node = node->left;
+      return node;
+    }
+    while (node->parent && node == node->parent->right)
+      node = node->parent;
+    return node->parent;
+  }
+
+  void _check_prefix() {
+    if (m_node &&
+        !has_prefix(key_view(KeyExtractor<T>::getKey(m_node->key)), m_prefix))
+      m_node = nullptr;
+  }
+};
+
+// begin/end pair so a query result can be used in a range-based for.
+template <typename Iter> class IteratorRange {
+public:
+  IteratorRange(Iter first, Iter last)
+      : m_begin(std::move(first)), m_end(std::move(last)) {}
+
+  Iter begin() const { return m_begin; }
+  Iter end() const { return m_end; }
+  bool empty() const { return m_begin == m_end; }
+
+private:
+  Iter m_begin;
+  Iter m_end;
+};
+
+#endif
@@ -5,25 +5,38 @@
 #include "../../interfaces/core/DataStructure.hpp"
 #include "../../interfaces/core/KeyExtractor.hpp"
 #include "../../interfaces/core/Node.hpp"
+#include "../../interfaces/enum/RehashMode.hpp"
+#include "FastHash.hpp"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
 #include <iostream>
 #include <optional>
 #include <stdexcept>
 #include <vector>
 
+// Linear probing over a power-of-two table. The full hash of every occupied
+// slot is kept in m_hashes, so probes only compare keys whose hashes match
+// and rehashing never calls Hash again.
+//
+// In INCREMENTAL mode growth does not move the elements at once: the previous
+// table is kept intact, so its probe chains stay valid, and every insert,
+// getNode or remove copies the next MIGRATION_STEP slots into the new table.
+// Lookups try the new table first and then the old one.
 template <typename T,
-          typename Hash = std::hash<std::decay_t<
+          typename Hash = FastHash<std::decay_t<
               decltype(KeyExtractor<T>::getKey(std::declval<T>()))>>>
 class OpenHashMap : public DataStructure<T> {
   using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
 
 public:
-  OpenHashMap(size_t tableSize = 19, float loadFactor = 0.75)
-      : m_table_size(get_next_prime(tableSize)), m_number_of_elements(0),
-        m_max_load_factor(loadFactor) {
+  OpenHashMap(size_t tableSize = 19, float loadFactor = 0.75,
+              RehashMode mode = STOP_THE_WORLD)
+      : m_table_size(next_power_of_two(tableSize)), m_number_of_elements(0),
+        m_max_load_factor(loadFactor), m_rehash_mode(mode) {
     m_table.resize(m_table_size);
+    m_hashes.resize(m_table_size);
   }
 
   void insert(T value) override { _insert(value); }
@@ -31,7 +44,7 @@ public:
   void remove(T value) override { _remove(KeyExtractor<T>::getKey(value)); }
 
   bool contains(T k) const override {
-    return _contains(KeyExtractor<T>::getKey(k));
+    return _find_node(KeyExtractor<T>::getKey(k)) != nullptr;
   }
 
   bool isEmpty() override { return m_number_of_elements == 0; }
@@ -44,25 +57,36 @@ public:
       else
         std::cout << "[" << i << "]: \n";
     }
+    for (size_t i = m_migrate_pos; i < m_old_table.size(); i++)
+      if (m_old_table[i].has_value())
+        std::cout << "[old " << i << "]: "
+                  << KeyExtractor<T>::getKey(m_old_table[i]->key) << "\n";
   }
 
   void clear() override { _clear(); }
 
+  // Presizes the table so `count` elements fit without intermediate rehashes,
+  // used when bulk loading a known number of entries.
+  void reserve(size_t count) {
+    size_t needed =
+        static_cast<size_t>(std::ceil(count / m_max_load_factor)) + 1;
+    if (needed > m_table_size)
+      rehash(needed);
+  }
+
   Node<T> *getNode(const T &value) override {
-    int idx = _find_slot(KeyExtractor<T>::getKey(value));
-    if (idx == -1)
-      return nullptr;
-    return &m_table[idx].value();
+    _migrate_step();
+    return const_cast<Node<T> *>(_find_node(KeyExtractor<T>::getKey(value)));
   }
 
+  // Changes whenever stored nodes move (rehash, migration, removal), so a
+  // pointer from getNode stays valid while the version is unchanged.
+  size_t layoutVersion() const { return m_layout_version; }
+
   std::vector<std::pair<std::string, int>> getOrderedContent() const override {
     std::vector<std::pair<std::string, int>> result;
-
-    for (const auto &bucket : m_table) {
-      if (bucket.has_value()) {
-        result.push_back(bucket->key);
-      }
-    }
+    result.reserve(m_number_of_elements);
+    forEach([&result](const T &value) { result.push_back(value); });
 
     std::sort(result.begin(), result.end(),
               [](const auto &a, const auto &b) { return a.first < b.first; });
@@ -70,57 +94,213 @@ public:
     return result;
   }
 
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (const auto &bucket : m_table)
+      if (bucket.has_value())
+        func(bucket->key);
+    for (size_t i = m_migrate_pos; i < m_old_table.size(); i++)
+      if (m_old_table[i].has_value())
+        func(m_old_table[i]->key);
+  }
+
+  // Batched operations. The keys are taken BATCH at a time: all their hashes
+  // are computed and their home slots prefetched before the first probe, so
+  // the cache misses of independent keys overlap instead of stalling one
+  // after another. Results match the one-at-a-time calls in order.
+  void insertBatch(const std::vector<T> &values) {
+    upsertBatch(values, [](T &, const T &) {});
+  }
+
+  void containsBatch(const std::vector<T> &values,
+                     std::vector<bool> &out) const {
+    out.assign(values.size(), false);
+    size_t hashes[BATCH];
+    for (size_t base = 0; base < values.size(); base += BATCH) {
+      size_t count = std::min(BATCH, values.size() - base);
+      _prefetch_block(&values[base], count, hashes);
+      for (size_t i = 0; i < count; i++)
+        out[base + i] = _find_node(KeyExtractor<T>::getKey(values[base + i]),
+                                   hashes[i]) != nullptr;
+    }
+  }
+
+  // Inserts each absent value; for a key already present (including one
+  // inserted earlier in the same batch) calls merge(stored, value) instead.
+  template <typename Merge>
+  void upsertBatch(const std::vector<T> &values, Merge merge) {
+    size_t hashes[BATCH];
+    for (size_t base = 0; base < values.size(); base += BATCH) {
+      size_t count = std::min(BATCH, values.size() - base);
+      _prefetch_block(&values[base], count, hashes);
+      for (size_t i = 0; i < count; i++) {
+        const T &value = values[base + i];
+        _migrate_step();
+        const Node<T> *node =
+            _find_node(KeyExtractor<T>::getKey(value), hashes[i]);
+        if (node)
+          merge(const_cast<Node<T> *>(node)->key, value);
+        else
+          _insert(value, hashes[i]);
+      }
+    }
+  }
+
 private:
+  // Old-table slots copied per update while an incremental resize runs. The
+  // new table is twice as large, so the migration always completes long
+  // before the next resize is due.
+  static constexpr size_t MIGRATION_STEP = 16;
+  // Keys whose slots are prefetched together by the batched operations.
+  static constexpr size_t BATCH = 16;
+
   std::vector<std::optional<Node<T>>> m_table;
+  std::vector<size_t> m_hashes;
   size_t m_table_size;
   size_t m_number_of_elements;
   float m_max_load_factor;
   Hash m_hash;
 
-  size_t hash_key(const KeyType &key) const {
-    return m_hash(key) % m_table_size;
-  }
+  RehashMode m_rehash_mode;
+  // Table being drained by an incremental resize; empty otherwise. Slots
+  // below m_migrate_pos have already been copied into m_table.
+  std::vector<std::optional<Node<T>>> m_old_table;
+  std::vector<size_t> m_old_hashes;
+  size_t m_migrate_pos{0};
+  size_t m_layout_version{0};
+
+  size_t full_hash(const KeyType &key) const { return mix_hash(m_hash(key)); }
 
-  int _find_slot(const KeyType &key) const {
-    size_t index = hash_key(key);
+  size_t mask() const { return m_table_size - 1; }
+
+  bool migrating() const { return !m_old_table.empty(); }
+
+  static int _find_slot(const std::vector<std::optional<Node<T>>> &table,
+                        const std::vector<size_t> &hashes, const KeyType &key,
+                        size_t hash) {
+    size_t tableMask = table.size() - 1;
+    size_t index = hash & tableMask;
     size_t start = index;
 
     do {
       PERF_TRACKER.incrementComparisons();
       PERF_TRACKER.incrementNodesVisited();
       PERF_TRACKER.incrementSearchDepth();
-      if (m_table[index].has_value() &&
-          KeyExtractor<T>::getKey(m_table[index]->key) == key) {
+      if (table[index].has_value() && hashes[index] == hash &&
+          KeyExtractor<T>::getKey(table[index]->key) == key) {
         return static_cast<int>(index);
       }
-      index = (index + 1) % m_table_size;
-    } while (m_table[index].has_value() && index != start);
+      index = (index + 1) & tableMask;
+    } while (table[index].has_value() && index != start);
 
     return -1;
   }
 
+  // Looks in the new table first: an element found there is current, and one
+  // only present in the old table has not been migrated yet.
+  const Node<T> *_find_node(const KeyType &key) const {
+    return _find_node(key, full_hash(key));
+  }
+
+  const Node<T> *_find_node(const KeyType &key, size_t hash) const {
+    int idx = _find_slot(m_table, m_hashes, key, hash);
+    if (idx != -1)
+      return &m_table[idx].value();
+    if (migrating()) {
+      idx = _find_slot(m_old_table, m_old_hashes, key, hash);
+      if (idx != -1)
+        return &m_old_table[idx].value();
+    }
+    return nullptr;
+  }
+
+  void _prefetch_block(const T *values, size_t count, size_t *hashes) const {
+    for (size_t i = 0; i < count; i++) {
+      hashes[i] = full_hash(KeyExtractor<T>::getKey(values[i]));
+      size_t index = hashes[i] & mask();
+      __builtin_prefetch(&m_hashes[index]);
+      __builtin_prefetch(&m_table[index]);
+    }
+  }
+
+  // Stores an element known to be absent, reusing its cached hash.
+  void _place(Node<T> node, size_t hash) {
+    size_t index = hash & mask();
+    while (m_table[index].has_value())
+      index = (index + 1) & mask();
+    m_table[index] = std::move(node);
+    m_hashes[index] = hash;
+  }
+
+  // Copies the next slice of the old table. Old slots are left in place so
+  // the probe chains of the entries still waiting stay intact.
+  void _migrate_step(size_t slots = MIGRATION_STEP) {
+    if (!migrating())
+      return;
+
+    m_layout_version++;
+    size_t end = std::min(m_old_table.size(), m_migrate_pos + slots);
+    for (; m_migrate_pos < end; m_migrate_pos++)
+      if (m_old_table[m_migrate_pos].has_value())
+        _place(*m_old_table[m_migrate_pos], m_old_hashes[m_migrate_pos]);
+
+    if (m_migrate_pos == m_old_table.size()) {
+      std::vector<std::optional<Node<T>>>().swap(m_old_table);
+      std::vector<size_t>().swap(m_old_hashes);
+      m_migrate_pos = 0;
+    }
+  }
+
+  void _finish_migration() { _migrate_step(m_old_table.size()); }
+
+  void _grow() {
+    if (m_rehash_mode == STOP_THE_WORLD) {
+      rehash(2 * m_table_size);
+      return;
+    }
+
+    _finish_migration();
+    m_old_table = std::move(m_table);
+    m_old_hashes = std::move(m_hashes);
+    m_migrate_pos = 0;
+    m_table_size *= 2;
+    m_table.clear();
+    m_table.resize(m_table_size);
+    m_hashes.assign(m_table_size, 0);
+  }
+
   void rehash(size_t new_size) {
-    new_size = get_next_prime(new_size);
-    std::vector<std::optional<Node<T>>> old_table = m_table;
+    _finish_migration();
+    m_layout_version++;
+    new_size = next_power_of_two(new_size);
+    std::vector<std::optional<Node<T>>> old_table = std::move(m_table);
+    std::vector<size_t> old_hashes = std::move(m_hashes);
     m_table.clear();
     m_table.resize(new_size);
+    m_hashes.assign(new_size, 0);
     m_table_size = new_size;
-    m_number_of_elements = 0;
 
-    for (const auto &entry : old_table) {
-      if (entry.has_value()) {
-        _insert(entry->key);
+    for (size_t i = 0; i < old_table.size(); i++) {
+      if (old_table[i].has_value()) {
+        _place(std::move(*old_table[i]), old_hashes[i]);
       }
     }
   }
 
   void _insert(const T &value) {
+    _migrate_step();
+    _insert(value, full_hash(KeyExtractor<T>::getKey(value)));
+  }
+
+  void _insert(const T &value, size_t hash) {
     if (load_factor() >= m_max_load_factor) {
-      rehash(2 * m_table_size);
+      _grow();
     }
 
-    KeyType key = KeyExtractor<T>::getKey(value);
-    size_t index = hash_key(key);
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    if (migrating() && _find_slot(m_old_table, m_old_hashes, key, hash) != -1)
+      return;
+
+    size_t index = hash & mask();
     size_t start = index;
 
     do {
@@ -130,67 +310,45 @@ private:
 
       if (!m_table[index].has_value()) {
         m_table[index] = Node<T>(value);
+        m_hashes[index] = hash;
         ++m_number_of_elements;
         return;
-      } else if (KeyExtractor<T>::getKey(m_table[index]->key) == key) {
+      } else if (m_hashes[index] == hash &&
+                 KeyExtractor<T>::getKey(m_table[index]->key) == key) {
         return;
       }
-      index = (index + 1) % m_table_size;
+      index = (index + 1) & mask();
     } while (index != start);
 
     throw std::overflow_error("Hash table overflow");
   }
 
-  bool _contains(const KeyType &key) const { return _find_slot(key) != -1; }
-
+  // Removal compacts the table with a same-size rehash, so any pending
+  // migration is completed first.
   void _remove(const KeyType &key) {
-    size_t index = hash_key(key);
-    size_t start = index;
-
-    do {
-      PERF_TRACKER.incrementComparisons();
-      PERF_TRACKER.incrementNodesVisited();
-      PERF_TRACKER.incrementSearchDepth();
-      if (m_table[index].has_value() &&
-          KeyExtractor<T>::getKey(m_table[index]->key) == key) {
-        m_table[index].reset();
-        --m_number_of_elements;
-        rehash(m_table_size);
-        return;
-      }
-      index = (index + 1) % m_table_size;
-    } while (m_table[index].has_value() && index != start);
+    _finish_migration();
+    int index = _find_slot(m_table, m_hashes, key, full_hash(key));
+    if (index == -1)
+      return;
+
+    m_table[index].reset();
+    --m_number_of_elements;
+    rehash(m_table_size);
   }
 
   void _clear() {
+    m_layout_version++;
     m_table.clear();
     m_table.resize(m_table_size);
+    std::vector<std::optional<Node<T>>>().swap(m_old_table);
+    std::vector<size_t>().swap(m_old_hashes);
+    m_migrate_pos = 0;
     m_number_of_elements = 0;
   }
 
   float load_factor() const {
     return static_cast<float>(m_number_of_elements) / m_table_size;
   }
-
-  size_t get_next_prime(size_t x) const {
-    if (x <= 2)
-      return 3;
-    if (x % 2 == 0)
-      ++x;
-
-    while (true) {
-      bool prime = true;
-      for (size_t i = 3; i * i <= x; i += 2) {
-        if (x % i == 0) {
-          prime = false;
-          break;
-        }
-      }
-      if (prime)
-        return x;
-      x += 2;
-    }
-  }
 };
 
-#endif // OPENHASHMAP_HPP
+#endif
@@ -0,0 +1,92 @@
+#ifndef PREFIX_KEY_HPP
+#define PREFIX_KEY_HPP
+
+#include "StringInterner.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// String key for the ordered trees that keeps its first 8 bytes inline as a
+// big-endian integer, zero padded. Comparing the prefixes as integers gives
+// the same order as comparing the bytes, so most comparisons in a tree
+// descent are a single integer compare that never touches the characters;
+// only keys sharing all 8 leading bytes fall back to memcmp on the tail.
+// The characters are not owned: the key points into a StringInterner arena.
+class PrefixKey {
+public:
+  PrefixKey() = default;
+
+  PrefixKey(const InternedString &text)
+      : m_prefix(_load_prefix(text.data(), text.size())), m_data(text.data()),
+        m_length(static_cast<uint32_t>(text.size())) {}
+
+  std::string_view view() const { return std::string_view(m_data, m_length); }
+  operator std::string() const { return std::string(m_data, m_length); }
+
+  friend bool operator==(const PrefixKey &a, const PrefixKey &b) {
+    if (a.m_prefix != b.m_prefix || a.m_length != b.m_length)
+      return false;
+    return a.m_data == b.m_data || a.m_length <= PREFIX_BYTES ||
+           std::memcmp(a.m_data + PREFIX_BYTES, b.m_data + PREFIX_BYTES,
+                       a.m_length - PREFIX_BYTES) == 0;
+  }
+  friend bool operator!=(const PrefixKey &a, const PrefixKey &b) {
+    return !(a == b);
+  }
+  friend bool operator<(const PrefixKey &a, const PrefixKey &b) {
+    if (a.m_prefix != b.m_prefix)
+      return a.m_prefix < b.m_prefix;
+    if (a.m_data == b.m_data)
+      return false;
+    size_t common = std::min(a.m_length, b.m_length);
+    if (common > PREFIX_BYTES) {
+      int cmp = std::memcmp(a.m_data + PREFIX_BYTES, b.m_data + PREFIX_BYTES,
+                            common - PREFIX_BYTES);
+      if (cmp != 0)
+        return cmp < 0;
+    }
+    return a.m_length < b.m_length;
+  }
+  friend bool operator>(const PrefixKey &a, const PrefixKey &b) {
+    return b < a;
+  }
+  friend bool operator<=(const PrefixKey &a, const PrefixKey &b) {
+    return !(b < a);
+  }
+  friend bool operator>=(const PrefixKey &a, const PrefixKey &b) {
+    return !(a < b);
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const PrefixKey &key) {
+    return os << key.view();
+  }
+
+private:
+  static constexpr size_t PREFIX_BYTES = 8;
+
+  uint64_t m_prefix{0};
+  const char *m_data{nullptr};
+  uint32_t m_length{0};
+
+  static uint64_t _load_prefix(const char *data, size_t length) {
+    uint64_t prefix = 0;
+    std::memcpy(&prefix, data, std::min(length, PREFIX_BYTES));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    prefix = __builtin_bswap64(prefix);
+#endif
+    return prefix;
+  }
+};
+
+inline std::ostream &operator<<(std::ostream &os,
+                                const std::pair<PrefixKey, int> &p) {
+  os << "(" << p.first << ", " << p.second << ")";
+  return os;
+}
+
+#endif
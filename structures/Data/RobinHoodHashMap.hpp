@@ -0,0 +1,221 @@
+#ifndef ROBINHOOD_HASHMAP_HPP
+#define ROBINHOOD_HASHMAP_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/DataStructure.hpp"
+#include "../../interfaces/core/KeyExtractor.hpp"
+#include "../../interfaces/core/Node.hpp"
+#include "FastHash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Open addressing with Robin Hood linear probing. Every slot records how far
+// its element sits from its home bucket; an insertion that has probed further
+// than the resident takes the slot and carries the resident on. Probe lengths
+// stay short and even, so a miss can stop as soon as it meets an element
+// closer to home than itself, and the table runs at a 0.9 load factor.
+// Deletion shifts the following cluster back one slot instead of leaving
+// tombstones.
+template <typename T,
+          typename Hash = FastHash<std::decay_t<
+              decltype(KeyExtractor<T>::getKey(std::declval<T>()))>>>
+class RobinHoodHashMap : public DataStructure<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+
+public:
+  RobinHoodHashMap(size_t tableSize = 19, float loadFactor = 0.9)
+      : m_table_size(next_power_of_two(tableSize)), m_number_of_elements(0),
+        m_max_load_factor(loadFactor) {
+    m_table.resize(m_table_size);
+    m_distances.resize(m_table_size, 0);
+    m_hashes.resize(m_table_size, 0);
+  }
+
+  void insert(T value) override { _insert(value); }
+
+  void remove(T value) override { _remove(KeyExtractor<T>::getKey(value)); }
+
+  bool contains(T k) const override {
+    return _find_slot(KeyExtractor<T>::getKey(k)) != NOT_FOUND;
+  }
+
+  bool isEmpty() override { return m_number_of_elements == 0; }
+
+  void show() override {
+    for (size_t i = 0; i < m_table_size; i++) {
+      if (m_distances[i])
+        std::cout << "[" << i
+                  << "]: " << KeyExtractor<T>::getKey(m_table[i]->key)
+                  << " (+" << m_distances[i] - 1 << ")\n";
+      else
+        std::cout << "[" << i << "]: \n";
+    }
+  }
+
+  void clear() override { _clear(); }
+
+  // Presizes the table so `count` elements fit without intermediate rehashes,
+  // used when bulk loading a known number of entries.
+  void reserve(size_t count) {
+    size_t needed =
+        static_cast<size_t>(std::ceil(count / m_max_load_factor)) + 1;
+    if (needed > m_table_size)
+      rehash(needed);
+  }
+
+  Node<T> *getNode(const T &value) override {
+    size_t idx = _find_slot(KeyExtractor<T>::getKey(value));
+    if (idx == NOT_FOUND)
+      return nullptr;
+    return &m_table[idx].value();
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    result.reserve(m_number_of_elements);
+    forEach([&result](const T &value) { result.push_back(value); });
+    std::sort(result.begin(), result.end(),
+              [](const auto &a, const auto &b) { return a.first < b.first; });
+    return result;
+  }
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (size_t i = 0; i < m_table_size; i++)
+      if (m_distances[i])
+        func(m_table[i]->key);
+  }
+
+  // Longest probe sequence currently in the table (0 = every element home).
+  size_t maxProbeLength() const {
+    uint32_t longest = 0;
+    for (uint32_t distance : m_distances)
+      longest = std::max(longest, distance);
+    return longest ? longest - 1 : 0;
+  }
+
+private:
+  static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+  std::vector<std::optional<Node<T>>> m_table;
+  // Probe distance + 1 of the element in each slot, 0 for an empty slot.
+  std::vector<uint32_t> m_distances;
+  std::vector<size_t> m_hashes;
+  size_t m_table_size;
+  size_t m_number_of_elements;
+  float m_max_load_factor;
+  Hash m_hash;
+
+  size_t full_hash(const KeyType &key) const { return mix_hash(m_hash(key)); }
+
+  size_t mask() const { return m_table_size - 1; }
+
+  // A resident closer to its home than we are to ours proves the key absent:
+  // had it been inserted, it would have displaced that resident.
+  size_t _find_slot(const KeyType &key) const {
+    size_t hash = full_hash(key);
+    size_t index = hash & mask();
+
+    for (uint32_t distance = 1;; distance++) {
+      PERF_TRACKER.incrementComparisons();
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      if (m_distances[index] < distance)
+        return NOT_FOUND;
+      if (m_hashes[index] == hash &&
+          KeyExtractor<T>::getKey(m_table[index]->key) == key)
+        return index;
+      index = (index + 1) & mask();
+    }
+  }
+
+  // Stores an element known to be absent, swapping it with any resident that
+  // is closer to home.
+  void _place(Node<T> node, size_t hash) {
+    size_t index = hash & mask();
+    uint32_t distance = 1;
+
+    while (m_distances[index]) {
+      PERF_TRACKER.incrementNodesVisited();
+      if (m_distances[index] < distance) {
+        std::swap(node, *m_table[index]);
+        std::swap(hash, m_hashes[index]);
+        std::swap(distance, m_distances[index]);
+      }
+      index = (index + 1) & mask();
+      distance++;
+    }
+
+    m_table[index] = std::move(node);
+    m_hashes[index] = hash;
+    m_distances[index] = distance;
+    ++m_number_of_elements;
+  }
+
+  void rehash(size_t new_size) {
+    new_size = next_power_of_two(new_size);
+    std::vector<std::optional<Node<T>>> old_table = std::move(m_table);
+    std::vector<uint32_t> old_distances = std::move(m_distances);
+    std::vector<size_t> old_hashes = std::move(m_hashes);
+
+    m_table.clear();
+    m_table.resize(new_size);
+    m_distances.assign(new_size, 0);
+    m_hashes.assign(new_size, 0);
+    m_table_size = new_size;
+    m_number_of_elements = 0;
+
+    for (size_t i = 0; i < old_table.size(); i++)
+      if (old_distances[i])
+        _place(std::move(*old_table[i]), old_hashes[i]);
+  }
+
+  void _insert(const T &value) {
+    KeyType key = KeyExtractor<T>::getKey(value);
+    if (_find_slot(key) != NOT_FOUND)
+      return;
+
+    if (static_cast<float>(m_number_of_elements + 1) / m_table_size >
+        m_max_load_factor)
+      rehash(2 * m_table_size);
+
+    _place(Node<T>(value), full_hash(key));
+  }
+
+  // Backward-shift deletion: every following element that is not at home
+  // moves one slot back, which keeps the distances exact without tombstones.
+  void _remove(const KeyType &key) {
+    size_t index = _find_slot(key);
+    if (index == NOT_FOUND)
+      return;
+
+    size_t next = (index + 1) & mask();
+    while (m_distances[next] > 1) {
+      PERF_TRACKER.incrementNodesVisited();
+      m_table[index] = std::move(m_table[next]);
+      m_hashes[index] = m_hashes[next];
+      m_distances[index] = m_distances[next] - 1;
+      index = next;
+      next = (next + 1) & mask();
+    }
+
+    m_table[index].reset();
+    m_distances[index] = 0;
+    --m_number_of_elements;
+  }
+
+  void _clear() {
+    m_table.clear();
+    m_table.resize(m_table_size);
+    m_distances.assign(m_table_size, 0);
+    m_number_of_elements = 0;
+  }
+};
+
+#endif
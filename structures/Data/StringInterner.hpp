@@ -0,0 +1,189 @@
+#ifndef STRING_INTERNER_HPP
+#define STRING_INTERNER_HPP
+
+#include "FastHash.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Compact handle to a string owned by a StringInterner: 16 bytes (pointer,
+// length, cached 32-bit hash) instead of a 32-byte std::string with its own
+// heap block. Interned strings are unique per interner, so equal handles
+// usually share the pointer and equality rarely reaches memcmp; ordering
+// matches std::string.
+class InternedString {
+public:
+  InternedString() = default;
+
+  const char *data() const { return m_data; }
+  size_t size() const { return m_length; }
+  uint32_t hash() const { return m_hash; }
+  bool valid() const { return m_data != nullptr; }
+
+  std::string_view view() const { return std::string_view(m_data, m_length); }
+  operator std::string() const { return std::string(m_data, m_length); }
+
+  friend bool operator==(const InternedString &a, const InternedString &b) {
+    if (a.m_data == b.m_data)
+      return true;
+    return a.m_length == b.m_length && a.m_hash == b.m_hash &&
+           std::memcmp(a.m_data, b.m_data, a.m_length) == 0;
+  }
+  friend bool operator!=(const InternedString &a, const InternedString &b) {
+    return !(a == b);
+  }
+  friend bool operator<(const InternedString &a, const InternedString &b) {
+    if (a.m_data == b.m_data)
+      return false;
+    int cmp =
+        std::memcmp(a.m_data, b.m_data, std::min(a.m_length, b.m_length));
+    return cmp < 0 || (cmp == 0 && a.m_length < b.m_length);
+  }
+  friend bool operator>(const InternedString &a, const InternedString &b) {
+    return b < a;
+  }
+  friend bool operator<=(const InternedString &a, const InternedString &b) {
+    return !(b < a);
+  }
+  friend bool operator>=(const InternedString &a, const InternedString &b) {
+    return !(a < b);
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const InternedString &s) {
+    return os << s.view();
+  }
+
+private:
+  friend class StringInterner;
+
+  InternedString(const char *data, uint32_t length, uint32_t hash)
+      : m_data(data), m_length(length), m_hash(hash) {}
+
+  const char *m_data{nullptr};
+  uint32_t m_length{0};
+  uint32_t m_hash{0};
+};
+
+inline std::ostream &operator<<(std::ostream &os,
+                                const std::pair<InternedString, int> &p) {
+  os << "(" << p.first << ", " << p.second << ")";
+  return os;
+}
+
+// The hash maps reuse the hash cached at interning time.
+template <> struct FastHash<InternedString> {
+  size_t operator()(const InternedString &key) const { return key.hash(); }
+};
+
+// Owns the characters of every interned string. Strings are copied once into
+// large blocks that never move, so handles stay valid for the interner's
+// lifetime; a power-of-two open-addressing table maps contents to handles.
+class StringInterner {
+public:
+  StringInterner() { m_slots.resize(INITIAL_SLOTS); }
+
+  StringInterner(const StringInterner &) = delete;
+  StringInterner &operator=(const StringInterner &) = delete;
+
+  // Returns the unique handle for `text`, copying it into the arena the
+  // first time it is seen.
+  InternedString intern(std::string_view text) {
+    uint32_t hash = _hash(text);
+    size_t index = _probe(text, hash);
+    if (m_slots[index].valid())
+      return m_slots[index];
+
+    if ((m_count + 1) * 4 > m_slots.size() * 3) {
+      _grow();
+      index = _probe(text, hash);
+    }
+
+    InternedString handle(_store(text), static_cast<uint32_t>(text.size()),
+                          hash);
+    m_slots[index] = handle;
+    m_count++;
+    return handle;
+  }
+
+  // Handle for `text` if it was interned before, an invalid one otherwise.
+  // Never allocates, so lookups of unknown words stay cheap.
+  InternedString find(std::string_view text) const {
+    return m_slots[_probe(text, _hash(text))];
+  }
+
+  size_t size() const { return m_count; }
+
+  // Bytes reserved for string contents.
+  size_t arenaBytes() const {
+    return m_blocks.size() * BLOCK_SIZE + m_large_bytes;
+  }
+
+private:
+  static constexpr size_t INITIAL_SLOTS = 64;
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+  std::vector<InternedString> m_slots;
+  size_t m_count{0};
+  std::vector<std::unique_ptr<char[]>> m_blocks;
+  std::vector<std::unique_ptr<char[]>> m_large;
+  size_t m_block_used{BLOCK_SIZE};
+  size_t m_large_bytes{0};
+
+  static uint32_t _hash(std::string_view text) {
+    return static_cast<uint32_t>(wyhash_bytes(text.data(), text.size()));
+  }
+
+  size_t _probe(std::string_view text, uint32_t hash) const {
+    size_t mask = m_slots.size() - 1;
+    size_t index = mix_hash(hash) & mask;
+    while (m_slots[index].valid() &&
+           (m_slots[index].hash() != hash || m_slots[index].view() != text))
+      index = (index + 1) & mask;
+    return index;
+  }
+
+  void _grow() {
+    std::vector<InternedString> old = std::move(m_slots);
+    m_slots.assign(old.size() * 2, InternedString());
+    size_t mask = m_slots.size() - 1;
+    for (const InternedString &handle : old) {
+      if (!handle.valid())
+        continue;
+      size_t index = mix_hash(handle.hash()) & mask;
+      while (m_slots[index].valid())
+        index = (index + 1) & mask;
+      m_slots[index] = handle;
+    }
+  }
+
+  // Copies `text` plus a terminator into the current block, starting a new
+  // block when it does not fit. Oversized strings get a block of their own.
+  const char *_store(std::string_view text) {
+    size_t needed = text.size() + 1;
+    char *dest;
+    if (needed > BLOCK_SIZE / 4) {
+      m_large.emplace_back(new char[needed]);
+      dest = m_large.back().get();
+      m_large_bytes += needed;
+    } else {
+      if (m_block_used + needed > BLOCK_SIZE) {
+        m_blocks.emplace_back(new char[BLOCK_SIZE]);
+        m_block_used = 0;
+      }
+      dest = m_blocks.back().get() + m_block_used;
+      m_block_used += needed;
+    }
+    std::memcpy(dest, text.data(), text.size());
+    dest[text.size()] = '\0';
+    return dest;
+  }
+};
+
+#endif
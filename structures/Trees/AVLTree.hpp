@@ -4,16 +4,15 @@
 #include "../../PerformanceTracker.hpp"
 #include "../../interfaces/core/Node.hpp"
 #include "../../interfaces/trees/rotatable/RotatableTree.hpp"
+#include "FrozenTree.hpp"
 #include "contexts/AVLTree/DeletionContext.hpp"
-#include "contexts/AVLTree/InsertionContext.hpp"
 #include "contexts/AVLTree/RotationContext.hpp"
 #include "utils/treeUtils.cpp"
 #include <iostream>
 #include <queue>
 #include <utility>
 
-template <typename T, typename InsertionCtx = AVLInsertionContext<T>,
-          typename DeletionCtx = AVLDeletionContext<T>,
+template <typename T, typename DeletionCtx = AVLDeletionContext<T>,
           template <typename> class RotationCtx = AVLRotationContext>
 class AVLTree : public RotatableTree<T, RotationCtx> {
   using Base = RotatableTree<T, RotationCtx>;
@@ -29,8 +28,12 @@ public:
   ~AVLTree() { clear(); };
 
   // Data Structure: methods
-  void insert(T value) override { m_root = _insert(m_root, value); };
-  void remove(T value) override { m_root = _remove(m_root, value); };
+  void insert(T value) override {
+    _insert(std::move(value));
+  };
+  void remove(T value) override {
+    m_root = _remove(m_root, value);
+  };
 
   // - maximum and minimum
   T minimum() override {
@@ -72,15 +75,19 @@ public:
     return _contains(m_root, key) != nullptr;
   };
 
-  bool isEmpty() override { return !_size(m_root); };
-  void clear() override { m_root = _clear(m_root); };
+  bool isEmpty() override { return !m_root; };
+  void clear() override {
+    m_root = _clear(m_root);
+  };
 
   // Tree methods
-  int size() override { return _size(m_root); };
+  int size() override { return subtree_size(m_root); };
   int height() override { return _tree_height(m_root); };
   void BFS() override { _BFS(m_root); };
   Node<T> *getRoot() const override { return m_root; }
   Node<T> *&getRootRef() override { return m_root; }
+  // The caller may change the count through the returned node and report
+  // it with countChanged.
   Node<T> *getNode(const T &value) override {
     KeyType key = KeyExtractor<T>::getKey(value);
     return _contains(m_root, key);
@@ -93,7 +100,27 @@ public:
     return result;
   }
 
+  // Replaces the content with a perfectly balanced tree built in O(n) from
+  // elements sorted by key without duplicates (e.g. a snapshot export).
+  void buildFromSorted(const std::vector<T> &sorted) {
+    clear();
+    m_root = build_balanced<T>(sorted, 0, sorted.size(), nullptr, 0,
+                               static_cast<size_t>(-1));
+  }
+
+  // Immutable, pointer-free copy for read-mostly phases.
+  FrozenTree<T> freeze() const {
+    std::vector<T> sorted;
+    sorted.reserve(subtree_size(m_root));
+    this->in_order([&sorted](Node<T> *node) { sorted.push_back(node->key); });
+    return FrozenTree<T>(sorted);
+  }
+
 private:
+  // Height bound for the insertion path: an AVL tree of height h holds at
+  // least Fib(h + 2) - 1 nodes, far beyond 2^64 at height 96.
+  static constexpr int MAX_HEIGHT = 96;
+
   Node<T> *m_root{nullptr};
   unsigned int rotations{0};
 
@@ -117,41 +144,93 @@ private:
     if (bal > 1) {
       rotations++;
       if (_balance(node->right) >= 0) {
-        return _rotate_left(node);
+        return _rotate_left(node, m_root);
       } else {
-        node->right = _rotate_right(node->right);
-        return _rotate_left(node);
+        node->right = _rotate_right(node->right, m_root);
+        return _rotate_left(node, m_root);
       }
     }
 
     else if (bal < -1) {
       rotations++;
       if (_balance(node->left) <= 0) {
-        return _rotate_right(node);
+        return _rotate_right(node, m_root);
       } else {
-        node->left = _rotate_left(node->left);
-        return _rotate_right(node);
+        node->left = _rotate_left(node->left, m_root);
+        return _rotate_right(node, m_root);
       }
     }
 
     node->height = 1 + greater_children_height(node);
+    update_subtree_size(node);
 
     return node;
   }
 
-  Node<T> *_insert(Node<T> *node, T value) {
-    InsertionCtx ctx(new Node<T>(value), m_root, value, 0);
-    Node<T> *inserted = ctx.useCaseAction();
+  // Single-pass insertion: one descent comparing keys only, recording the
+  // path, then a retrace that stops at the first ancestor whose height is
+  // unchanged, or right after the single (double) rotation an insertion can
+  // need, since that restores the subtree's previous height. Subtree sizes
+  // still grow by one along the whole path. Keys already present are left
+  // untouched and the value is moved into the new node.
+  void _insert(T value) {
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    Node<T> *path[MAX_HEIGHT];
+    int depth = 0;
+
+    for (Node<T> *node = m_root; node;) {
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key < nodeKey) {
+        path[depth++] = node;
+        node = node->left;
+      } else if (nodeKey < key) {
+        path[depth++] = node;
+        node = node->right;
+      } else {
+        return;
+      }
+    }
+
+    if (depth == 0) {
+      m_root = new Node<T>(std::move(value));
+      return;
+    }
 
-    while (inserted) {
-      InsertionCtx ctx(inserted, m_root, value, _balance(inserted));
-      ctx.fixupAction();
+    Node<T> *parent = path[depth - 1];
+    bool goLeft = key < KeyExtractor<T>::getKey(parent->key);
+    Node<T> *inserted = new Node<T>(std::move(value));
+    inserted->parent = parent;
+    (goLeft ? parent->left : parent->right) = inserted;
 
-      inserted->height = 1 + greater_children_height(inserted);
-      inserted = inserted->parent;
+    for (int i = 0; i < depth; i++) {
+      path[i]->size++;
+      path[i]->maxCount = std::max(path[i]->maxCount, inserted->maxCount);
     }
 
-    return inserted ? inserted : m_root;
+    for (int i = depth - 1; i >= 0; i--) {
+      Node<T> *node = path[i];
+      int bal = _balance(node);
+
+      if (bal < -1 || bal > 1) {
+        PERF_TRACKER.incrementInsertionFixups();
+        rotations++;
+        if (bal < -1) {
+          if (_balance(node->left) > 0)
+            _rotate_left(node->left, m_root);
+          _rotate_right(node, m_root);
+        } else {
+          if (_balance(node->right) < 0)
+            _rotate_right(node->right, m_root);
+          _rotate_left(node, m_root);
+        }
+        return;
+      }
+
+      unsigned int height = 1 + greater_children_height(node);
+      if (height == node->height)
+        return;
+      node->height = height;
+    }
   }
 
   Node<T> *_contains(Node<T> *node, const KeyType &key) const {
@@ -272,22 +351,26 @@ private:
 
     if (valueKey < nodeKey) {
       node->left = _remove(node->left, value);
+      if (node->left)
+        node->left->parent = node;
     } else if (valueKey > nodeKey) {
       node->right = _remove(node->right, value);
+      if (node->right)
+        node->right->parent = node;
     } else {
       // Node found
-      if (node->left == nullptr) {
-        Node<T> *temp = node->right;
-        delete node;
-        return temp;
-      } else if (node->right == nullptr) {
-        Node<T> *temp = node->left;
+      if (node->left == nullptr || node->right == nullptr) {
+        Node<T> *temp = node->left ? node->left : node->right;
+        if (temp)
+          temp->parent = node->parent;
         delete node;
         return temp;
       } else {
         Node<T> *temp = _minimum(node->right);
         node->key = temp->key;
         node->right = _remove(node->right, temp->key);
+        if (node->right)
+          node->right->parent = node;
       }
     }
     return _fixup_deletion(node);
@@ -320,13 +403,6 @@ private:
     }
     std::cout << std::endl;
   }
-
-  int _size(Node<T> *node) {
-    if (node == nullptr)
-      return 0;
-
-    return 1 + _size(node->left) + _size(node->right);
-  }
 };
 
 #endif
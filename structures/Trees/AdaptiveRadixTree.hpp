@@ -0,0 +1,1122 @@
+#ifndef ADAPTIVE_RADIX_TREE_HPP
+#define ADAPTIVE_RADIX_TREE_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/DataStructure.hpp"
+#include "../../interfaces/core/KeyExtractor.hpp"
+#include "../../interfaces/core/Node.hpp"
+#include "../../interfaces/core/SortedNavigable.hpp"
+#include "../Data/Iterator.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Adaptive radix tree (Leis et al.) over string keys. Inner nodes branch on
+// one byte and grow through four layouts as their fan-out rises: Node4 and
+// Node16 keep sorted key bytes (Node16 is searched with one SSE2 compare),
+// Node48 maps bytes to 48 child slots and Node256 indexes children directly.
+// Runs of single-child nodes are collapsed into a per-node prefix, so a
+// lookup costs O(key length) regardless of n and never compares whole keys
+// until it reaches a leaf.
+//
+// Leaves are the Node<T> themselves, so getNode pointers are stable. A key
+// that is a proper prefix of other keys ("a" vs "ab") is kept in the
+// `terminal` slot of the inner node where it ends. Every inner node counts
+// the elements below it, which gives O(key length) rank and select.
+template <typename T>
+class AdaptiveRadixTree : public DataStructure<T>, public SortedNavigable<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+  static_assert(std::is_same<std::decay_t<KeyType>, std::string>::value,
+                "AdaptiveRadixTree needs std::string keys");
+
+public:
+  using typename SortedNavigable<T>::RangeCallback;
+
+  AdaptiveRadixTree() {};
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+  AdaptiveRadixTree &operator=(const AdaptiveRadixTree &) = delete;
+  ~AdaptiveRadixTree() { clear(); };
+
+  void insert(T value) override {
+    const std::string &key = KeyExtractor<T>::getKey(value);
+    if (_insert(m_root, key, 0, value))
+      m_size++;
+  }
+
+  void remove(T value) override {
+    if (_remove(m_root, KeyExtractor<T>::getKey(value), 0))
+      m_size--;
+  }
+
+  bool contains(T value) const override {
+    return _find(KeyExtractor<T>::getKey(value)) != nullptr;
+  }
+
+  // The caller may change the count through the returned node and report
+  // it with countChanged.
+  Node<T> *getNode(const T &value) override {
+    return _find(KeyExtractor<T>::getKey(value));
+  }
+
+  // Adds `delta` to the count of the stored entry with the key of `value`
+  // and returns its leaf, or nullptr when the key is absent.
+  Node<T> *addCount(const T &value, int delta) {
+    Node<T> *leaf = getNode(value);
+    if (leaf) {
+      leaf->key.second += delta;
+      countChanged(leaf);
+    }
+    return leaf;
+  }
+
+  // Restores maxCount on the path to `leaf` after its count changed in
+  // place, bottom-up and stopping at the first node whose summary holds.
+  void countChanged(Node<T> *leaf) {
+    if (m_root && !_is_leaf(m_root))
+      _count_changed(static_cast<Inner *>(m_root),
+                     KeyExtractor<T>::getKey(leaf->key), 0);
+  }
+
+  bool isEmpty() override { return m_size == 0; }
+  int size() const { return static_cast<int>(m_size); }
+
+  void show() override { _show(m_root, 0); }
+
+  void clear() override {
+    _destroy(m_root);
+    m_root = nullptr;
+    m_size = 0;
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    result.reserve(m_size);
+    _walk(m_root, [&result](const T &value) { result.push_back(value); });
+    return result;
+  }
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    _walk(m_root, func);
+  }
+
+  // Prefix queries: every key starting with `prefix`, in order. The subtree
+  // holding them is found in O(prefix length).
+  void forEachWithPrefix(const std::string &prefix,
+                         const RangeCallback &func) const {
+    void *subtree = _prefix_subtree(prefix);
+    if (subtree)
+      _walk(subtree, func);
+  }
+
+  int countWithPrefix(const std::string &prefix) const {
+    return static_cast<int>(_count(_prefix_subtree(prefix)));
+  }
+
+  class PrefixIterator;
+
+  // Iterator form of forEachWithPrefix: O(prefix length) to reach the
+  // subtree, then O(1) amortized per key.
+  IteratorRange<PrefixIterator> prefixRange(const std::string &prefix) const {
+    return {PrefixIterator(_prefix_subtree(prefix)), PrefixIterator()};
+  }
+
+  // The k entries with the highest count among the keys starting with
+  // `prefix`, by count and then key. All matches sit in one subtree, which is
+  // expanded best-first on the per-node maxCount, so only the nodes leading
+  // to the k results are opened. As in Tree::topKByPrefix, maxCount is
+  // kept by insertions and removals, and by countChanged for a count
+  // changed in place.
+  std::vector<T> topKByPrefix(const std::string &prefix, size_t k) {
+    std::vector<T> result;
+    void *subtree = _prefix_subtree(prefix);
+    if (!subtree || k == 0)
+      return result;
+
+    std::priority_queue<Ranked, std::vector<Ranked>, RankedBelow> candidates;
+    auto push = [&candidates](const void *ref) {
+      if (_is_leaf(ref)) {
+        Node<T> *leaf = _as_leaf(ref);
+        candidates.push({leaf, nullptr, leaf->key.second});
+      } else {
+        const Inner *node = static_cast<const Inner *>(ref);
+        candidates.push({nullptr, node, node->maxCount});
+      }
+    };
+
+    push(subtree);
+    while (result.size() < k && !candidates.empty()) {
+      Ranked best = candidates.top();
+      candidates.pop();
+      PERF_TRACKER.incrementNodesVisited();
+      if (best.leaf) {
+        result.push_back(best.leaf->key);
+        continue;
+      }
+      if (best.inner->terminal)
+        push(_leaf_ref(best.inner->terminal));
+      _for_each_child(best.inner, [&push](uint8_t, void *child) {
+        push(child);
+        return true;
+      });
+    }
+    return result;
+  }
+
+  // SortedNavigable methods
+  T minimum() override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+    return select(0);
+  }
+
+  T maximum() override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+    return select(static_cast<int>(m_size) - 1);
+  }
+
+  T successor(T value) override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+    size_t k = _rank(KeyExtractor<T>::getKey(value), true);
+    if (k >= m_size)
+      throw std::runtime_error("No successor exists for this value");
+    return select(static_cast<int>(k));
+  }
+
+  T predecessor(T value) override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+    size_t k = _rank(KeyExtractor<T>::getKey(value), false);
+    if (k == 0)
+      throw std::runtime_error("No predecessor exists for this value");
+    return select(static_cast<int>(k) - 1);
+  }
+
+  int rank(T value) override {
+    return static_cast<int>(_rank(KeyExtractor<T>::getKey(value), false));
+  }
+
+  T select(int k) override {
+    if (k < 0 || static_cast<size_t>(k) >= m_size)
+      throw std::out_of_range("Rank out of range");
+
+    size_t remaining = static_cast<size_t>(k);
+    void *ref = m_root;
+    while (!_is_leaf(ref)) {
+      Inner *node = static_cast<Inner *>(ref);
+      if (node->terminal) {
+        if (remaining == 0)
+          return node->terminal->key;
+        remaining--;
+      }
+      _for_each_child(node, [&](uint8_t, void *child) {
+        size_t count = _count(child);
+        if (remaining < count) {
+          ref = child;
+          return false;
+        }
+        remaining -= count;
+        return true;
+      });
+    }
+    return _as_leaf(ref)->key;
+  }
+
+  int countRange(T lo, T hi) override {
+    const std::string &loKey = KeyExtractor<T>::getKey(lo);
+    const std::string &hiKey = KeyExtractor<T>::getKey(hi);
+    if (hiKey < loKey)
+      return 0;
+    return static_cast<int>(_rank(hiKey, true) - _rank(loKey, false));
+  }
+
+  // Skips every subtree whose path already falls outside [lo, hi], so the
+  // cost is O(key length + output size).
+  void forEachInRange(T lo, T hi, const RangeCallback &func) override {
+    std::string path;
+    _walk_range(m_root, path, KeyExtractor<T>::getKey(lo),
+                KeyExtractor<T>::getKey(hi), func);
+  }
+
+private:
+  enum NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+  struct Inner {
+    NodeType type;
+    uint16_t count{0};  // children
+    size_t leaves{0};   // elements in the subtree, terminal included
+    int maxCount{0};    // largest count in the subtree (topKByPrefix)
+    std::string prefix; // compressed path below the parent's branch byte
+    Node<T> *terminal{nullptr};
+
+    explicit Inner(NodeType type) : type(type) {}
+  };
+
+  struct Node4 : Inner {
+    uint8_t keys[4]{};
+    void *children[4]{};
+    Node4() : Inner(NODE4) {}
+  };
+
+  struct Node16 : Inner {
+    uint8_t keys[16]{};
+    void *children[16]{};
+    Node16() : Inner(NODE16) {}
+  };
+
+  // index[byte] is the child slot + 1, or 0 when the byte has no child.
+  struct Node48 : Inner {
+    uint8_t index[256]{};
+    void *children[48]{};
+    Node48() : Inner(NODE48) {}
+  };
+
+  struct Node256 : Inner {
+    void *children[256]{};
+    Node256() : Inner(NODE256) {}
+  };
+
+  void *m_root{nullptr};
+  size_t m_size{0};
+
+  // A leaf ranked by its count or an inner node ranked by its maxCount. At
+  // equal rank inner nodes are opened first, so equal counts come out in key
+  // order.
+  struct Ranked {
+    Node<T> *leaf;
+    const Inner *inner;
+    int rank;
+  };
+
+  struct RankedBelow {
+    bool operator()(const Ranked &a, const Ranked &b) const {
+      if (a.rank != b.rank)
+        return a.rank < b.rank;
+      if (!a.leaf || !b.leaf)
+        return a.leaf && !b.leaf;
+      return KeyExtractor<T>::getKey(b.leaf->key) <
+             KeyExtractor<T>::getKey(a.leaf->key);
+    }
+  };
+
+  // A child reference is either an Inner* or a leaf Node<T>* with the low
+  // bit set.
+  static bool _is_leaf(const void *ref) {
+    return reinterpret_cast<uintptr_t>(ref) & 1;
+  }
+  static Node<T> *_as_leaf(const void *ref) {
+    return reinterpret_cast<Node<T> *>(reinterpret_cast<uintptr_t>(ref) &
+                                       ~static_cast<uintptr_t>(1));
+  }
+  static void *_leaf_ref(Node<T> *leaf) {
+    return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(leaf) | 1);
+  }
+  static const std::string &_leaf_key(const void *ref) {
+    return KeyExtractor<T>::getKey(_as_leaf(ref)->key);
+  }
+
+  static int _max_count(const void *ref) {
+    if (!ref)
+      return 0;
+    return _is_leaf(ref) ? element_count(_as_leaf(ref)->key)
+                         : static_cast<const Inner *>(ref)->maxCount;
+  }
+
+  // Recomputes the maxCount of `node` from its terminal and children.
+  static void _pull_max_count(Inner *node) {
+    int best = node->terminal ? element_count(node->terminal->key) : 0;
+    _for_each_child(node, [&best](uint8_t, void *child) {
+      best = std::max(best, _max_count(child));
+      return true;
+    });
+    node->maxCount = best;
+  }
+
+  // Returns whether the maxCount of `node` changed. An unchanged or grown
+  // count below it is folded in directly; otherwise the node is recomputed
+  // from its children.
+  static bool _count_changed(Inner *node, const std::string &key,
+                             size_t depth) {
+    depth += node->prefix.size();
+    int count;
+    if (depth == key.size()) {
+      count = element_count(node->terminal->key);
+    } else {
+      void *child = *_find_child(node, static_cast<uint8_t>(key[depth]));
+      if (!_is_leaf(child) &&
+          !_count_changed(static_cast<Inner *>(child), key, depth + 1))
+        return false;
+      count = _max_count(child);
+    }
+
+    int previous = node->maxCount;
+    if (count >= previous)
+      node->maxCount = count;
+    else
+      _pull_max_count(node);
+    return node->maxCount != previous;
+  }
+
+  static size_t _count(const void *ref) {
+    if (!ref)
+      return 0;
+    return _is_leaf(ref) ? 1 : static_cast<const Inner *>(ref)->leaves;
+  }
+
+  // Child slot for `byte`, or nullptr.
+  static void **_find_child(Inner *node, uint8_t byte) {
+    switch (node->type) {
+    case NODE4: {
+      Node4 *n = static_cast<Node4 *>(node);
+      for (int i = 0; i < n->count; i++)
+        if (n->keys[i] == byte)
+          return &n->children[i];
+      return nullptr;
+    }
+    case NODE16: {
+      Node16 *n = static_cast<Node16 *>(node);
+#if defined(__SSE2__)
+      __m128i cmp = _mm_cmpeq_epi8(
+          _mm_set1_epi8(static_cast<char>(byte)),
+          _mm_loadu_si128(reinterpret_cast<const __m128i *>(n->keys)));
+      int mask = _mm_movemask_epi8(cmp) & ((1 << n->count) - 1);
+      return mask ? &n->children[__builtin_ctz(mask)] : nullptr;
+#else
+      for (int i = 0; i < n->count; i++)
+        if (n->keys[i] == byte)
+          return &n->children[i];
+      return nullptr;
+#endif
+    }
+    case NODE48: {
+      Node48 *n = static_cast<Node48 *>(node);
+      return n->index[byte] ? &n->children[n->index[byte] - 1] : nullptr;
+    }
+    case NODE256: {
+      Node256 *n = static_cast<Node256 *>(node);
+      return n->children[byte] ? &n->children[byte] : nullptr;
+    }
+    }
+    return nullptr;
+  }
+
+  // Visits the children in byte order until func returns false.
+  template <typename Func>
+  static void _for_each_child(const Inner *node, Func func) {
+    switch (node->type) {
+    case NODE4: {
+      const Node4 *n = static_cast<const Node4 *>(node);
+      for (int i = 0; i < n->count; i++)
+        if (!func(n->keys[i], n->children[i]))
+          return;
+      return;
+    }
+    case NODE16: {
+      const Node16 *n = static_cast<const Node16 *>(node);
+      for (int i = 0; i < n->count; i++)
+        if (!func(n->keys[i], n->children[i]))
+          return;
+      return;
+    }
+    case NODE48: {
+      const Node48 *n = static_cast<const Node48 *>(node);
+      for (int b = 0; b < 256; b++)
+        if (n->index[b] && !func(static_cast<uint8_t>(b),
+                                 n->children[n->index[b] - 1]))
+          return;
+      return;
+    }
+    case NODE256: {
+      const Node256 *n = static_cast<const Node256 *>(node);
+      for (int b = 0; b < 256; b++)
+        if (n->children[b] && !func(static_cast<uint8_t>(b), n->children[b]))
+          return;
+      return;
+    }
+    }
+  }
+
+  template <typename Sorted>
+  static void _sorted_insert(Sorted *n, uint8_t byte, void *child) {
+    int pos = n->count;
+    while (pos > 0 && n->keys[pos - 1] > byte) {
+      n->keys[pos] = n->keys[pos - 1];
+      n->children[pos] = n->children[pos - 1];
+      pos--;
+    }
+    n->keys[pos] = byte;
+    n->children[pos] = child;
+    n->count++;
+  }
+
+  static void _copy_header(Inner *to, Inner *from) {
+    to->count = 0;
+    to->leaves = from->leaves;
+    to->maxCount = from->maxCount;
+    to->prefix = std::move(from->prefix);
+    to->terminal = from->terminal;
+  }
+
+  // Adds a child, replacing `ref` with the next larger layout when full.
+  static void _add_child(void *&ref, uint8_t byte, void *child) {
+    Inner *node = static_cast<Inner *>(ref);
+    switch (node->type) {
+    case NODE4: {
+      Node4 *n = static_cast<Node4 *>(node);
+      if (n->count < 4) {
+        _sorted_insert(n, byte, child);
+        return;
+      }
+      Node16 *grown = new Node16();
+      _copy_header(grown, n);
+      for (int i = 0; i < n->count; i++)
+        _sorted_insert(grown, n->keys[i], n->children[i]);
+      _sorted_insert(grown, byte, child);
+      delete n;
+      ref = grown;
+      return;
+    }
+    case NODE16: {
+      Node16 *n = static_cast<Node16 *>(node);
+      if (n->count < 16) {
+        _sorted_insert(n, byte, child);
+        return;
+      }
+      Node48 *grown = new Node48();
+      _copy_header(grown, n);
+      for (int i = 0; i < n->count; i++) {
+        grown->children[i] = n->children[i];
+        grown->index[n->keys[i]] = static_cast<uint8_t>(i + 1);
+      }
+      grown->count = n->count;
+      delete n;
+      ref = grown;
+      _add_child(ref, byte, child);
+      return;
+    }
+    case NODE48: {
+      Node48 *n = static_cast<Node48 *>(node);
+      if (n->count < 48) {
+        int slot = 0;
+        while (n->children[slot])
+          slot++;
+        n->children[slot] = child;
+        n->index[byte] = static_cast<uint8_t>(slot + 1);
+        n->count++;
+        return;
+      }
+      Node256 *grown = new Node256();
+      _copy_header(grown, n);
+      for (int b = 0; b < 256; b++)
+        if (n->index[b])
+          grown->children[b] = n->children[n->index[b] - 1];
+      grown->count = n->count;
+      delete n;
+      ref = grown;
+      _add_child(ref, byte, child);
+      return;
+    }
+    case NODE256: {
+      Node256 *n = static_cast<Node256 *>(node);
+      n->children[byte] = child;
+      n->count++;
+      return;
+    }
+    }
+  }
+
+  // Drops the child for `byte`, moving to the next smaller layout once the
+  // fan-out falls well below its capacity (with hysteresis against
+  // grow/shrink flapping).
+  static void _remove_child(void *&ref, uint8_t byte) {
+    Inner *node = static_cast<Inner *>(ref);
+    switch (node->type) {
+    case NODE4:
+    case NODE16: {
+      uint8_t *keys = node->type == NODE4 ? static_cast<Node4 *>(node)->keys
+                                          : static_cast<Node16 *>(node)->keys;
+      void **children = node->type == NODE4
+                            ? static_cast<Node4 *>(node)->children
+                            : static_cast<Node16 *>(node)->children;
+      int pos = 0;
+      while (keys[pos] != byte)
+        pos++;
+      for (int i = pos + 1; i < node->count; i++) {
+        keys[i - 1] = keys[i];
+        children[i - 1] = children[i];
+      }
+      node->count--;
+
+      if (node->type == NODE16 && node->count <= 3) {
+        Node16 *n = static_cast<Node16 *>(node);
+        Node4 *shrunk = new Node4();
+        _copy_header(shrunk, n);
+        for (int i = 0; i < n->count; i++)
+          _sorted_insert(shrunk, n->keys[i], n->children[i]);
+        delete n;
+        ref = shrunk;
+      }
+      return;
+    }
+    case NODE48: {
+      Node48 *n = static_cast<Node48 *>(node);
+      n->children[n->index[byte] - 1] = nullptr;
+      n->index[byte] = 0;
+      n->count--;
+
+      if (n->count <= 12) {
+        Node16 *shrunk = new Node16();
+        _copy_header(shrunk, n);
+        for (int b = 0; b < 256; b++)
+          if (n->index[b])
+            _sorted_insert(shrunk, static_cast<uint8_t>(b),
+                           n->children[n->index[b] - 1]);
+        delete n;
+        ref = shrunk;
+      }
+      return;
+    }
+    case NODE256: {
+      Node256 *n = static_cast<Node256 *>(node);
+      n->children[byte] = nullptr;
+      n->count--;
+
+      if (n->count <= 37) {
+        Node48 *shrunk = new Node48();
+        _copy_header(shrunk, n);
+        for (int b = 0; b < 256; b++) {
+          if (n->children[b]) {
+            shrunk->children[shrunk->count] = n->children[b];
+            shrunk->index[b] = static_cast<uint8_t>(++shrunk->count);
+          }
+        }
+        delete n;
+        ref = shrunk;
+      }
+      return;
+    }
+    }
+  }
+
+  // Length of the common prefix of the node's compressed path and key[depth..].
+  static size_t _prefix_match(const Inner *node, const std::string &key,
+                              size_t depth) {
+    size_t limit = std::min(node->prefix.size(), key.size() - depth);
+    size_t i = 0;
+    while (i < limit && node->prefix[i] == key[depth + i])
+      i++;
+    return i;
+  }
+
+  Node<T> *_find(const std::string &key) const {
+    void *ref = m_root;
+    size_t depth = 0;
+
+    while (ref) {
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      if (_is_leaf(ref)) {
+        PERF_TRACKER.incrementComparisons();
+        return _leaf_key(ref) == key ? _as_leaf(ref) : nullptr;
+      }
+
+      Inner *node = static_cast<Inner *>(ref);
+      PERF_TRACKER.incrementComparisons();
+      if (_prefix_match(node, key, depth) != node->prefix.size())
+        return nullptr;
+      depth += node->prefix.size();
+      if (depth == key.size())
+        return node->terminal;
+
+      void **child = _find_child(node, static_cast<uint8_t>(key[depth]));
+      if (!child)
+        return nullptr;
+      ref = *child;
+      depth++;
+    }
+    return nullptr;
+  }
+
+  // Returns false when the key was already present.
+  bool _insert(void *&ref, const std::string &key, size_t depth,
+               const T &value) {
+    PERF_TRACKER.incrementNodesVisited();
+    if (!ref) {
+      ref = _leaf_ref(new Node<T>(value));
+      return true;
+    }
+
+    if (_is_leaf(ref)) {
+      const std::string &other = _leaf_key(ref);
+      PERF_TRACKER.incrementComparisons();
+      if (other == key)
+        return false;
+
+      // Replace the leaf by a node holding both keys below their common path.
+      size_t common = 0;
+      size_t limit = std::min(other.size(), key.size());
+      while (depth + common < limit &&
+             other[depth + common] == key[depth + common])
+        common++;
+
+      Node4 *split = new Node4();
+      split->prefix = key.substr(depth, common);
+      split->leaves = 2;
+      split->maxCount = std::max(_max_count(ref), element_count(value));
+      void *split_ref = split;
+      _attach(split_ref, other, depth + common, ref);
+      _attach(split_ref, key, depth + common, _leaf_ref(new Node<T>(value)));
+      ref = split_ref;
+      return true;
+    }
+
+    Inner *node = static_cast<Inner *>(ref);
+    PERF_TRACKER.incrementComparisons();
+    size_t matched = _prefix_match(node, key, depth);
+    if (matched < node->prefix.size()) {
+      // The key leaves the compressed path: split it at the mismatch.
+      Node4 *split = new Node4();
+      split->prefix = node->prefix.substr(0, matched);
+      split->leaves = node->leaves + 1;
+      split->maxCount = std::max(node->maxCount, element_count(value));
+      uint8_t branch = static_cast<uint8_t>(node->prefix[matched]);
+      node->prefix.erase(0, matched + 1);
+      void *split_ref = split;
+      _add_child(split_ref, branch, node);
+      _attach(split_ref, key, depth + matched, _leaf_ref(new Node<T>(value)));
+      ref = split_ref;
+      return true;
+    }
+
+    depth += node->prefix.size();
+    if (depth == key.size()) {
+      if (node->terminal)
+        return false;
+      node->terminal = new Node<T>(value);
+      node->leaves++;
+      node->maxCount = std::max(node->maxCount, element_count(value));
+      return true;
+    }
+
+    uint8_t byte = static_cast<uint8_t>(key[depth]);
+    void **child = _find_child(node, byte);
+    if (child) {
+      if (!_insert(*child, key, depth + 1, value))
+        return false;
+      node->leaves++;
+      node->maxCount = std::max(node->maxCount, element_count(value));
+      return true;
+    }
+
+    node->leaves++;
+    node->maxCount = std::max(node->maxCount, element_count(value));
+    _add_child(ref, byte, _leaf_ref(new Node<T>(value)));
+    return true;
+  }
+
+  // Hangs a leaf whose key continues at `depth` below a fresh split node.
+  static void _attach(void *&split_ref, const std::string &key, size_t depth,
+                      void *leaf) {
+    if (depth == key.size())
+      static_cast<Inner *>(split_ref)->terminal = _as_leaf(leaf);
+    else
+      _add_child(split_ref, static_cast<uint8_t>(key[depth]), leaf);
+  }
+
+  // Returns true when the key was found and removed.
+  bool _remove(void *&ref, const std::string &key, size_t depth) {
+    if (!ref)
+      return false;
+
+    PERF_TRACKER.incrementNodesVisited();
+    if (_is_leaf(ref)) {
+      PERF_TRACKER.incrementComparisons();
+      if (_leaf_key(ref) != key)
+        return false;
+      delete _as_leaf(ref);
+      ref = nullptr;
+      return true;
+    }
+
+    Inner *node = static_cast<Inner *>(ref);
+    PERF_TRACKER.incrementComparisons();
+    if (_prefix_match(node, key, depth) != node->prefix.size())
+      return false;
+    depth += node->prefix.size();
+
+    if (depth == key.size()) {
+      if (!node->terminal)
+        return false;
+      delete node->terminal;
+      node->terminal = nullptr;
+    } else {
+      uint8_t byte = static_cast<uint8_t>(key[depth]);
+      void **child = _find_child(node, byte);
+      if (!child || !_remove(*child, key, depth + 1))
+        return false;
+      if (!*child)
+        _remove_child(ref, byte);
+    }
+
+    node = static_cast<Inner *>(ref);
+    node->leaves--;
+    _pull_max_count(node);
+    _collapse(ref);
+    return true;
+  }
+
+  // Restores path compression after a removal: a node left with a single
+  // element (terminal or child) is replaced by that element.
+  static void _collapse(void *&ref) {
+    Inner *node = static_cast<Inner *>(ref);
+    if (node->count == 0) {
+      ref = node->terminal ? _leaf_ref(node->terminal) : nullptr;
+      _free_inner(node);
+      return;
+    }
+    if (node->count > 1 || node->terminal)
+      return;
+
+    uint8_t byte = 0;
+    void *only = nullptr;
+    _for_each_child(node, [&](uint8_t b, void *child) {
+      byte = b;
+      only = child;
+      return false;
+    });
+
+    if (!_is_leaf(only)) {
+      Inner *child = static_cast<Inner *>(only);
+      child->prefix = node->prefix + static_cast<char>(byte) + child->prefix;
+    }
+    ref = only;
+    _free_inner(node);
+  }
+
+  // Root of the subtree holding every key that starts with `prefix`.
+  void *_prefix_subtree(const std::string &prefix) const {
+    void *ref = m_root;
+    size_t depth = 0;
+
+    while (ref) {
+      if (_is_leaf(ref)) {
+        const std::string &key = _leaf_key(ref);
+        return key.compare(0, prefix.size(), prefix) == 0 ? ref : nullptr;
+      }
+
+      Inner *node = static_cast<Inner *>(ref);
+      size_t matched = _prefix_match(node, prefix, depth);
+      if (depth + matched == prefix.size())
+        return ref;
+      if (matched < node->prefix.size())
+        return nullptr;
+      depth += node->prefix.size();
+
+      void **child = _find_child(node, static_cast<uint8_t>(prefix[depth]));
+      if (!child)
+        return nullptr;
+      ref = *child;
+      depth++;
+    }
+    return nullptr;
+  }
+
+  // Number of keys < key (<= key when inclusive).
+  size_t _rank(const std::string &key, bool inclusive) const {
+    size_t count = 0;
+    void *ref = m_root;
+    size_t depth = 0;
+
+    while (ref) {
+      if (_is_leaf(ref)) {
+        const std::string &leafKey = _leaf_key(ref);
+        if (leafKey < key || (inclusive && leafKey == key))
+          count++;
+        return count;
+      }
+
+      Inner *node = static_cast<Inner *>(ref);
+      size_t matched = _prefix_match(node, key, depth);
+      if (matched < node->prefix.size()) {
+        // Either the key ran out inside the path (every key below is
+        // larger) or the first differing byte orders the whole subtree.
+        if (depth + matched < key.size() &&
+            static_cast<uint8_t>(key[depth + matched]) >
+                static_cast<uint8_t>(node->prefix[matched]))
+          count += node->leaves;
+        return count;
+      }
+      depth += node->prefix.size();
+
+      if (depth == key.size())
+        return count + (inclusive && node->terminal ? 1 : 0);
+      if (node->terminal)
+        count++;
+
+      uint8_t byte = static_cast<uint8_t>(key[depth]);
+      void *next = nullptr;
+      _for_each_child(node, [&](uint8_t b, void *child) {
+        if (b < byte) {
+          count += _count(child);
+          return true;
+        }
+        if (b == byte)
+          next = child;
+        return false;
+      });
+      ref = next;
+      depth++;
+    }
+    return count;
+  }
+
+  // Position of the first child at or after `pos` (a slot for Node4/16, a
+  // byte for Node48/256), or -1; the child itself goes to `child`.
+  static int _next_child(const Inner *node, int pos, void *&child) {
+    switch (node->type) {
+    case NODE4:
+    case NODE16: {
+      if (pos >= node->count)
+        return -1;
+      child = node->type == NODE4
+                  ? static_cast<const Node4 *>(node)->children[pos]
+                  : static_cast<const Node16 *>(node)->children[pos];
+      return pos;
+    }
+    case NODE48: {
+      const Node48 *n = static_cast<const Node48 *>(node);
+      for (int b = pos; b < 256; b++) {
+        if (n->index[b]) {
+          child = n->children[n->index[b] - 1];
+          return b;
+        }
+      }
+      return -1;
+    }
+    case NODE256: {
+      const Node256 *n = static_cast<const Node256 *>(node);
+      for (int b = pos; b < 256; b++) {
+        if (n->children[b]) {
+          child = n->children[b];
+          return b;
+        }
+      }
+      return -1;
+    }
+    }
+    return -1;
+  }
+
+  template <typename Func> static void _walk(const void *ref, Func &&func) {
+    if (!ref)
+      return;
+    if (_is_leaf(ref)) {
+      func(_as_leaf(ref)->key);
+      return;
+    }
+    const Inner *node = static_cast<const Inner *>(ref);
+    if (node->terminal)
+      func(node->terminal->key);
+    _for_each_child(node, [&](uint8_t, void *child) {
+      _walk(child, func);
+      return true;
+    });
+  }
+
+  // In-order walk restricted to [lo, hi]; `path` holds the bytes leading to
+  // ref. Returns false once a key above hi is reached.
+  static bool _walk_range(const void *ref, std::string &path,
+                          const std::string &lo, const std::string &hi,
+                          const RangeCallback &func) {
+    if (!ref)
+      return true;
+    if (_is_leaf(ref)) {
+      const std::string &key = _leaf_key(ref);
+      if (hi < key)
+        return false;
+      if (!(key < lo))
+        func(_as_leaf(ref)->key);
+      return true;
+    }
+
+    const Inner *node = static_cast<const Inner *>(ref);
+    size_t restore = path.size();
+    path += node->prefix;
+
+    // Every key below starts with path.
+    if (path.compare(0, path.size(), lo, 0, path.size()) < 0) {
+      path.resize(restore);
+      return true;
+    }
+    if (path.compare(0, path.size(), hi, 0, path.size()) > 0) {
+      path.resize(restore);
+      return false;
+    }
+
+    bool more = true;
+    if (node->terminal && !(path < lo))
+      func(node->terminal->key);
+
+    _for_each_child(node, [&](uint8_t byte, void *child) {
+      path.push_back(static_cast<char>(byte));
+      more = _walk_range(child, path, lo, hi, func);
+      path.pop_back();
+      return more;
+    });
+
+    path.resize(restore);
+    return more;
+  }
+
+  static void _destroy(void *ref) {
+    if (!ref)
+      return;
+    if (_is_leaf(ref)) {
+      delete _as_leaf(ref);
+      return;
+    }
+    Inner *node = static_cast<Inner *>(ref);
+    _for_each_child(node, [](uint8_t, void *child) {
+      _destroy(child);
+      return true;
+    });
+    delete node->terminal;
+    _free_inner(node);
+  }
+
+  // Inner has no virtual destructor; free through the concrete layout.
+  static void _free_inner(Inner *node) {
+    switch (node->type) {
+    case NODE4:
+      delete static_cast<Node4 *>(node);
+      break;
+    case NODE16:
+      delete static_cast<Node16 *>(node);
+      break;
+    case NODE48:
+      delete static_cast<Node48 *>(node);
+      break;
+    case NODE256:
+      delete static_cast<Node256 *>(node);
+      break;
+    }
+  }
+
+  static void _show(const void *ref, int indent) {
+    if (!ref)
+      return;
+    std::string pad(indent * 2, ' ');
+    if (_is_leaf(ref)) {
+      std::cout << pad << _as_leaf(ref)->key << "\n";
+      return;
+    }
+    const Inner *node = static_cast<const Inner *>(ref);
+    static const char *names[] = {"Node4", "Node16", "Node48", "Node256"};
+    std::cout << pad << "[" << names[node->type] << " \"" << node->prefix
+              << "\" " << node->leaves << "]\n";
+    if (node->terminal)
+      std::cout << pad << "  " << node->terminal->key << "\n";
+    _for_each_child(node, [&](uint8_t byte, void *child) {
+      std::cout << pad << "  '" << static_cast<char>(byte) << "':\n";
+      _show(child, indent + 2);
+      return true;
+    });
+  }
+};
+
+// In-order iterator over one subtree, resumable through a stack of
+// (inner node, next child position) frames; position 0 of a node with a
+// terminal is entered after the terminal itself has been returned.
+template <typename T> class AdaptiveRadixTree<T>::PrefixIterator {
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const T *;
+  using reference = const T &;
+
+  PrefixIterator() = default;
+  explicit PrefixIterator(const void *subtree) {
+    if (subtree)
+      _descend(subtree);
+  }
+
+  reference operator*() const { return m_current->key; }
+  pointer operator->() const { return &m_current->key; }
+  Node<T> *node() const { return m_current; }
+
+  PrefixIterator &operator++() {
+    _advance();
+    return *this;
+  }
+
+  PrefixIterator operator++(int) {
+    PrefixIterator previous = *this;
+    _advance();
+    return previous;
+  }
+
+  friend bool operator==(const PrefixIterator &a, const PrefixIterator &b) {
+    return a.m_current == b.m_current;
+  }
+  friend bool operator!=(const PrefixIterator &a, const PrefixIterator &b) {
+    return a.m_current != b.m_current;
+  }
+
+private:
+  struct Frame {
+    const Inner *node;
+    int next;
+  };
+
+  std::vector<Frame> m_stack;
+  Node<T> *m_current{nullptr};
+
+  // Moves to the smallest key below `ref`.
+  void _descend(const void *ref) {
+    while (!_is_leaf(ref)) {
+      const Inner *node = static_cast<const Inner *>(ref);
+      if (node->terminal) {
+        m_stack.push_back({node, 0});
+        m_current = node->terminal;
+        return;
+      }
+      void *child = nullptr;
+      int pos = _next_child(node, 0, child);
+      m_stack.push_back({node, pos + 1});
+      ref = child;
+    }
+    m_current = _as_leaf(ref);
+  }
+
+  void _advance() {
+    while (!m_stack.empty()) {
+      void *child = nullptr;
+      int pos = _next_child(m_stack.back().node, m_stack.back().next, child);
+      if (pos < 0) {
+        m_stack.pop_back();
+        continue;
+      }
+      m_stack.back().next = pos + 1;
+      _descend(child);
+      return;
+    }
+    m_current = nullptr;
+  }
+};
+
+#endif
@@ -0,0 +1,620 @@
+#ifndef BPLUSTREE_HPP
+#define BPLUSTREE_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/DataStructure.hpp"
+#include "../../interfaces/core/KeyExtractor.hpp"
+#include "../../interfaces/core/Node.hpp"
+#include "../../interfaces/core/SortedNavigable.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// High-fanout ordered structure. Keys live contiguously inside each node so a
+// whole node is searched with a binary search over a few cache lines, and the
+// leaves are chained for range scans. Inner nodes also keep the element count
+// of every child, which gives O(log n) rank/select.
+//
+// Elements are kept in heap Node<T>s referenced from the leaves, so the
+// pointers handed out by getNode stay valid across splits and merges.
+template <typename T, size_t NodeBytes = 1024>
+class BPlusTree : public DataStructure<T>, public SortedNavigable<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+  using Key = std::decay_t<KeyType>;
+
+  static constexpr size_t MAX_KEYS =
+      std::max<size_t>(4, NodeBytes / (sizeof(Key) + sizeof(void *)));
+  static constexpr size_t MIN_KEYS = MAX_KEYS / 2;
+
+  // Every array has one slack slot so a node can overflow by one element
+  // before it is split.
+  struct BNode {
+    bool leaf;
+    uint16_t count{0};
+    Key keys[MAX_KEYS + 1];
+
+    explicit BNode(bool leaf) : leaf(leaf) {}
+  };
+
+  struct Leaf : BNode {
+    Node<T> *values[MAX_KEYS + 1];
+    Leaf *next{nullptr};
+    Leaf *prev{nullptr};
+
+    Leaf() : BNode(true) {}
+  };
+
+  // keys[i] is the smallest key reachable through children[i + 1].
+  struct Inner : BNode {
+    BNode *children[MAX_KEYS + 2];
+    size_t sizes[MAX_KEYS + 2];
+
+    Inner() : BNode(false) {}
+  };
+
+  struct Split {
+    BNode *right{nullptr};
+    Key separator{};
+  };
+
+public:
+  using typename SortedNavigable<T>::RangeCallback;
+
+  BPlusTree() {};
+  BPlusTree(const BPlusTree &) = delete;
+  BPlusTree &operator=(const BPlusTree &) = delete;
+  ~BPlusTree() { clear(); };
+
+  // Data Structure: methods
+  void insert(T value) override {
+    if (!m_root)
+      m_root = new Leaf();
+
+    bool inserted = false;
+    Split split = _insert(m_root, KeyExtractor<T>::getKey(value), value,
+                          inserted);
+    if (inserted)
+      m_size++;
+
+    if (split.right) {
+      Inner *root = new Inner();
+      root->keys[0] = std::move(split.separator);
+      root->children[0] = m_root;
+      root->children[1] = split.right;
+      root->sizes[0] = _count(m_root);
+      root->sizes[1] = _count(split.right);
+      root->count = 1;
+      m_root = root;
+    }
+  }
+
+  void remove(T value) override {
+    if (!m_root)
+      return;
+
+    if (_remove(m_root, KeyExtractor<T>::getKey(value)))
+      m_size--;
+
+    if (m_root->leaf && m_root->count == 0) {
+      delete static_cast<Leaf *>(m_root);
+      m_root = nullptr;
+    } else if (!m_root->leaf && m_root->count == 0) {
+      Inner *old = static_cast<Inner *>(m_root);
+      m_root = old->children[0];
+      delete old;
+    }
+  }
+
+  bool contains(T k) const override {
+    return _find(KeyExtractor<T>::getKey(k)) != nullptr;
+  }
+
+  Node<T> *getNode(const T &value) override {
+    return _find(KeyExtractor<T>::getKey(value));
+  }
+
+  bool isEmpty() override { return m_size == 0; }
+  void clear() override {
+    _clear(m_root);
+    m_root = nullptr;
+    m_size = 0;
+  }
+
+  int size() { return static_cast<int>(m_size); }
+  int height() {
+    int levels = 0;
+    for (BNode *node = m_root; node;
+         node = node->leaf ? nullptr : static_cast<Inner *>(node)->children[0])
+      levels++;
+    return levels;
+  }
+
+  // One line per level, one bracket per node.
+  void show() override {
+    if (!m_root)
+      return;
+
+    std::queue<BNode *> level;
+    level.push(m_root);
+    while (!level.empty()) {
+      size_t width = level.size();
+      for (size_t n = 0; n < width; n++) {
+        BNode *node = level.front();
+        level.pop();
+        std::cout << "[";
+        for (size_t i = 0; i < node->count; i++) {
+          if (node->leaf)
+            std::cout << (i ? " " : "")
+                      << static_cast<Leaf *>(node)->values[i]->key;
+          else
+            std::cout << (i ? " " : "") << node->keys[i];
+        }
+        std::cout << "] ";
+        if (!node->leaf)
+          for (size_t i = 0; i <= node->count; i++)
+            level.push(static_cast<Inner *>(node)->children[i]);
+      }
+      std::cout << "\n";
+    }
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    result.reserve(m_size);
+    for (Leaf *leaf = _first_leaf(); leaf; leaf = leaf->next)
+      for (size_t i = 0; i < leaf->count; i++)
+        result.push_back(leaf->values[i]->key);
+    return result;
+  }
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (Leaf *leaf = _first_leaf(); leaf; leaf = leaf->next)
+      for (size_t i = 0; i < leaf->count; i++)
+        func(leaf->values[i]->key);
+  }
+
+  // SortedNavigable methods
+  T minimum() override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+    return _first_leaf()->values[0]->key;
+  }
+
+  T maximum() override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+    Leaf *leaf = _last_leaf();
+    return leaf->values[leaf->count - 1]->key;
+  }
+
+  T successor(T value) override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    Leaf *leaf = _find_leaf(key);
+    size_t pos = _upper_bound(leaf, key);
+    if (pos == leaf->count) {
+      leaf = leaf->next;
+      pos = 0;
+    }
+    if (!leaf)
+      throw std::runtime_error("No successor exists for this value");
+    return leaf->values[pos]->key;
+  }
+
+  T predecessor(T value) override {
+    if (!m_size)
+      throw std::runtime_error("Tree is empty");
+
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    Leaf *leaf = _find_leaf(key);
+    size_t pos = _lower_bound(leaf, key);
+    if (pos == 0) {
+      leaf = leaf->prev;
+      pos = leaf ? leaf->count : 0;
+    }
+    if (!leaf)
+      throw std::runtime_error("No predecessor exists for this value");
+    return leaf->values[pos - 1]->key;
+  }
+
+  int rank(T value) override {
+    return static_cast<int>(_rank(KeyExtractor<T>::getKey(value), false));
+  }
+
+  T select(int k) override {
+    if (k < 0 || static_cast<size_t>(k) >= m_size)
+      throw std::out_of_range("Rank out of range");
+
+    size_t remaining = static_cast<size_t>(k);
+    BNode *node = m_root;
+    while (!node->leaf) {
+      Inner *inner = static_cast<Inner *>(node);
+      size_t i = 0;
+      while (remaining >= inner->sizes[i]) {
+        remaining -= inner->sizes[i];
+        i++;
+      }
+      node = inner->children[i];
+    }
+    return static_cast<Leaf *>(node)->values[remaining]->key;
+  }
+
+  int countRange(T lo, T hi) override {
+    const KeyType &loKey = KeyExtractor<T>::getKey(lo);
+    const KeyType &hiKey = KeyExtractor<T>::getKey(hi);
+    if (hiKey < loKey)
+      return 0;
+    return static_cast<int>(_rank(hiKey, true) - _rank(loKey, false));
+  }
+
+  // Descends once to the first key >= lo and then follows the leaf chain.
+  void forEachInRange(T lo, T hi, const RangeCallback &func) override {
+    if (!m_root)
+      return;
+
+    const KeyType &loKey = KeyExtractor<T>::getKey(lo);
+    const KeyType &hiKey = KeyExtractor<T>::getKey(hi);
+    Leaf *leaf = _find_leaf(loKey);
+    size_t pos = _lower_bound(leaf, loKey);
+
+    for (; leaf; leaf = leaf->next, pos = 0) {
+      for (; pos < leaf->count; pos++) {
+        if (hiKey < leaf->keys[pos])
+          return;
+        func(leaf->values[pos]->key);
+      }
+    }
+  }
+
+private:
+  BNode *m_root{nullptr};
+  size_t m_size{0};
+
+  static bool _element_less(const Key &a, const KeyType &b) {
+    PERF_TRACKER.incrementComparisons();
+    return a < b;
+  }
+
+  static bool _key_less(const KeyType &a, const Key &b) {
+    PERF_TRACKER.incrementComparisons();
+    return a < b;
+  }
+
+  static size_t _lower_bound(const BNode *node, const KeyType &key) {
+    return std::lower_bound(node->keys, node->keys + node->count, key,
+                            _element_less) -
+           node->keys;
+  }
+
+  static size_t _upper_bound(const BNode *node, const KeyType &key) {
+    return std::upper_bound(node->keys, node->keys + node->count, key,
+                            _key_less) -
+           node->keys;
+  }
+
+  static size_t _count(BNode *node) {
+    if (node->leaf)
+      return node->count;
+
+    Inner *inner = static_cast<Inner *>(node);
+    size_t total = 0;
+    for (size_t i = 0; i <= inner->count; i++)
+      total += inner->sizes[i];
+    return total;
+  }
+
+  Leaf *_find_leaf(const KeyType &key) const {
+    BNode *node = m_root;
+    while (node && !node->leaf) {
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      node = static_cast<Inner *>(node)->children[_upper_bound(node, key)];
+    }
+    return static_cast<Leaf *>(node);
+  }
+
+  Leaf *_first_leaf() const {
+    BNode *node = m_root;
+    while (node && !node->leaf)
+      node = static_cast<Inner *>(node)->children[0];
+    return static_cast<Leaf *>(node);
+  }
+
+  Leaf *_last_leaf() const {
+    BNode *node = m_root;
+    while (node && !node->leaf)
+      node = static_cast<Inner *>(node)->children[node->count];
+    return static_cast<Leaf *>(node);
+  }
+
+  Node<T> *_find(const KeyType &key) const {
+    Leaf *leaf = _find_leaf(key);
+    if (!leaf)
+      return nullptr;
+
+    PERF_TRACKER.incrementNodesVisited();
+    PERF_TRACKER.incrementSearchDepth();
+    size_t pos = _lower_bound(leaf, key);
+    if (pos < leaf->count && !(key < leaf->keys[pos]))
+      return leaf->values[pos];
+    return nullptr;
+  }
+
+  // Number of keys smaller than `key` (or smaller or equal, if `inclusive`).
+  size_t _rank(const KeyType &key, bool inclusive) const {
+    size_t count = 0;
+    BNode *node = m_root;
+    if (!node)
+      return 0;
+
+    // Every child left of the search path holds only smaller keys.
+    while (!node->leaf) {
+      Inner *inner = static_cast<Inner *>(node);
+      size_t i = _upper_bound(node, key);
+      for (size_t c = 0; c < i; c++)
+        count += inner->sizes[c];
+      node = inner->children[i];
+    }
+
+    return count +
+           (inclusive ? _upper_bound(node, key) : _lower_bound(node, key));
+  }
+
+  Split _insert(BNode *node, const KeyType &key, const T &value,
+                bool &inserted) {
+    PERF_TRACKER.incrementNodesVisited();
+    PERF_TRACKER.incrementSearchDepth();
+
+    if (node->leaf) {
+      Leaf *leaf = static_cast<Leaf *>(node);
+      size_t pos = _lower_bound(leaf, key);
+      if (pos < leaf->count && !(key < leaf->keys[pos]))
+        return {};
+
+      std::move_backward(leaf->keys + pos, leaf->keys + leaf->count,
+                         leaf->keys + leaf->count + 1);
+      std::move_backward(leaf->values + pos, leaf->values + leaf->count,
+                         leaf->values + leaf->count + 1);
+      leaf->keys[pos] = key;
+      leaf->values[pos] = new Node<T>(value);
+      leaf->count++;
+      inserted = true;
+
+      return leaf->count > MAX_KEYS ? _split_leaf(leaf) : Split{};
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    size_t i = _upper_bound(inner, key);
+    Split split = _insert(inner->children[i], key, value, inserted);
+    if (inserted)
+      inner->sizes[i]++;
+    if (!split.right)
+      return {};
+
+    std::move_backward(inner->keys + i, inner->keys + inner->count,
+                       inner->keys + inner->count + 1);
+    std::move_backward(inner->children + i + 1,
+                       inner->children + inner->count + 1,
+                       inner->children + inner->count + 2);
+    std::move_backward(inner->sizes + i + 1, inner->sizes + inner->count + 1,
+                       inner->sizes + inner->count + 2);
+    inner->keys[i] = std::move(split.separator);
+    inner->children[i + 1] = split.right;
+    inner->sizes[i] = _count(inner->children[i]);
+    inner->sizes[i + 1] = _count(split.right);
+    inner->count++;
+
+    return inner->count > MAX_KEYS ? _split_inner(inner) : Split{};
+  }
+
+  Split _split_leaf(Leaf *leaf) {
+    size_t mid = leaf->count / 2;
+    Leaf *right = new Leaf();
+
+    std::move(leaf->keys + mid, leaf->keys + leaf->count, right->keys);
+    std::copy(leaf->values + mid, leaf->values + leaf->count, right->values);
+    right->count = leaf->count - mid;
+    leaf->count = mid;
+
+    right->next = leaf->next;
+    right->prev = leaf;
+    if (leaf->next)
+      leaf->next->prev = right;
+    leaf->next = right;
+
+    return {right, right->keys[0]};
+  }
+
+  Split _split_inner(Inner *inner) {
+    size_t mid = inner->count / 2;
+    Inner *right = new Inner();
+
+    std::move(inner->keys + mid + 1, inner->keys + inner->count, right->keys);
+    std::copy(inner->children + mid + 1, inner->children + inner->count + 1,
+              right->children);
+    std::copy(inner->sizes + mid + 1, inner->sizes + inner->count + 1,
+              right->sizes);
+    right->count = inner->count - mid - 1;
+    inner->count = mid;
+
+    return {right, std::move(inner->keys[mid])};
+  }
+
+  bool _remove(BNode *node, const KeyType &key) {
+    PERF_TRACKER.incrementNodesVisited();
+    PERF_TRACKER.incrementSearchDepth();
+
+    if (node->leaf) {
+      Leaf *leaf = static_cast<Leaf *>(node);
+      size_t pos = _lower_bound(leaf, key);
+      if (pos == leaf->count || key < leaf->keys[pos])
+        return false;
+
+      delete leaf->values[pos];
+      std::move(leaf->keys + pos + 1, leaf->keys + leaf->count,
+                leaf->keys + pos);
+      std::move(leaf->values + pos + 1, leaf->values + leaf->count,
+                leaf->values + pos);
+      leaf->count--;
+      return true;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    size_t i = _upper_bound(inner, key);
+    if (!_remove(inner->children[i], key))
+      return false;
+
+    inner->sizes[i]--;
+    if (inner->children[i]->count < MIN_KEYS)
+      _rebalance(inner, i);
+    return true;
+  }
+
+  // Fixes an underflowing children[i] by borrowing from a sibling that can
+  // spare a key, or by merging with one.
+  void _rebalance(Inner *parent, size_t i) {
+    BNode *left = i > 0 ? parent->children[i - 1] : nullptr;
+    BNode *right = i < parent->count ? parent->children[i + 1] : nullptr;
+
+    if (left && left->count > MIN_KEYS)
+      _borrow_from_left(parent, i);
+    else if (right && right->count > MIN_KEYS)
+      _borrow_from_right(parent, i);
+    else if (left)
+      _merge(parent, i - 1);
+    else if (right)
+      _merge(parent, i);
+  }
+
+  void _borrow_from_left(Inner *parent, size_t i) {
+    BNode *child = parent->children[i];
+    BNode *left = parent->children[i - 1];
+
+    std::move_backward(child->keys, child->keys + child->count,
+                       child->keys + child->count + 1);
+
+    if (child->leaf) {
+      Leaf *c = static_cast<Leaf *>(child);
+      Leaf *l = static_cast<Leaf *>(left);
+      std::move_backward(c->values, c->values + c->count,
+                         c->values + c->count + 1);
+      c->keys[0] = std::move(l->keys[l->count - 1]);
+      c->values[0] = l->values[l->count - 1];
+      parent->keys[i - 1] = c->keys[0];
+      parent->sizes[i - 1]--;
+      parent->sizes[i]++;
+    } else {
+      Inner *c = static_cast<Inner *>(child);
+      Inner *l = static_cast<Inner *>(left);
+      std::move_backward(c->children, c->children + c->count + 1,
+                         c->children + c->count + 2);
+      std::move_backward(c->sizes, c->sizes + c->count + 1,
+                         c->sizes + c->count + 2);
+      c->keys[0] = std::move(parent->keys[i - 1]);
+      c->children[0] = l->children[l->count];
+      c->sizes[0] = l->sizes[l->count];
+      parent->keys[i - 1] = std::move(l->keys[l->count - 1]);
+      parent->sizes[i - 1] -= c->sizes[0];
+      parent->sizes[i] += c->sizes[0];
+    }
+
+    child->count++;
+    left->count--;
+  }
+
+  void _borrow_from_right(Inner *parent, size_t i) {
+    BNode *child = parent->children[i];
+    BNode *right = parent->children[i + 1];
+
+    if (child->leaf) {
+      Leaf *c = static_cast<Leaf *>(child);
+      Leaf *r = static_cast<Leaf *>(right);
+      c->keys[c->count] = std::move(r->keys[0]);
+      c->values[c->count] = r->values[0];
+      std::move(r->keys + 1, r->keys + r->count, r->keys);
+      std::move(r->values + 1, r->values + r->count, r->values);
+      parent->keys[i] = r->keys[0];
+      parent->sizes[i]++;
+      parent->sizes[i + 1]--;
+    } else {
+      Inner *c = static_cast<Inner *>(child);
+      Inner *r = static_cast<Inner *>(right);
+      c->keys[c->count] = std::move(parent->keys[i]);
+      c->children[c->count + 1] = r->children[0];
+      c->sizes[c->count + 1] = r->sizes[0];
+      parent->keys[i] = std::move(r->keys[0]);
+      parent->sizes[i] += r->sizes[0];
+      parent->sizes[i + 1] -= r->sizes[0];
+      std::move(r->keys + 1, r->keys + r->count, r->keys);
+      std::move(r->children + 1, r->children + r->count + 1, r->children);
+      std::move(r->sizes + 1, r->sizes + r->count + 1, r->sizes);
+    }
+
+    child->count++;
+    right->count--;
+  }
+
+  // Merges children[i + 1] into children[i] and drops separator keys[i].
+  void _merge(Inner *parent, size_t i) {
+    BNode *left = parent->children[i];
+    BNode *right = parent->children[i + 1];
+
+    if (left->leaf) {
+      Leaf *l = static_cast<Leaf *>(left);
+      Leaf *r = static_cast<Leaf *>(right);
+      std::move(r->keys, r->keys + r->count, l->keys + l->count);
+      std::copy(r->values, r->values + r->count, l->values + l->count);
+      l->count += r->count;
+      l->next = r->next;
+      if (r->next)
+        r->next->prev = l;
+      delete r;
+    } else {
+      Inner *l = static_cast<Inner *>(left);
+      Inner *r = static_cast<Inner *>(right);
+      l->keys[l->count] = std::move(parent->keys[i]);
+      std::move(r->keys, r->keys + r->count, l->keys + l->count + 1);
+      std::copy(r->children, r->children + r->count + 1,
+                l->children + l->count + 1);
+      std::copy(r->sizes, r->sizes + r->count + 1, l->sizes + l->count + 1);
+      l->count += r->count + 1;
+      delete r;
+    }
+
+    parent->sizes[i] += parent->sizes[i + 1];
+    std::move(parent->keys + i + 1, parent->keys + parent->count,
+              parent->keys + i);
+    std::move(parent->children + i + 2, parent->children + parent->count + 1,
+              parent->children + i + 1);
+    std::move(parent->sizes + i + 2, parent->sizes + parent->count + 1,
+              parent->sizes + i + 1);
+    parent->count--;
+  }
+
+  void _clear(BNode *node) {
+    if (!node)
+      return;
+
+    if (node->leaf) {
+      Leaf *leaf = static_cast<Leaf *>(node);
+      for (size_t i = 0; i < leaf->count; i++)
+        delete leaf->values[i];
+      delete leaf;
+      return;
+    }
+
+    Inner *inner = static_cast<Inner *>(node);
+    for (size_t i = 0; i <= inner->count; i++)
+      _clear(inner->children[i]);
+    delete inner;
+  }
+};
+
+#endif
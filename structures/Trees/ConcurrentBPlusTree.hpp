@@ -0,0 +1,663 @@
+#ifndef CONCURRENTBPLUSTREE_HPP
+#define CONCURRENTBPLUSTREE_HPP
+
+#include "../../interfaces/core/DataStructure.hpp"
+#include "../../interfaces/core/KeyExtractor.hpp"
+#include "../../interfaces/core/Node.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// B+ tree for concurrent readers and writers with optimistic lock coupling.
+// Every node has a version counter whose bit 1 marks a writer. Readers take
+// no lock: they note the version of a node, read it, and check that the
+// version did not move before trusting what they read, restarting from the
+// root otherwise. Writers lock only the nodes they change, so lookups never
+// write to shared memory and scale with the number of cores.
+//
+// Full nodes are split on the way down, so a split only ever locks the node
+// and its parent. Removals just take the element out of its leaf; nodes are
+// not merged.
+//
+// Elements are kept in heap Node<T>s referenced from the leaves, as in
+// BPlusTree; inner nodes hold their own copies of the separator keys. An
+// element is never changed once a leaf points at it: upsert links a merged
+// copy in its place, so a reader that found a node always sees a whole
+// element. Replaced and removed elements are retired and freed by epoch-based
+// reclamation once no operation that could have seen them is still running.
+//
+// insert, remove, upsert, contains and find are safe to call from any number
+// of threads. getNode hands out the stored node, which must not be changed
+// and may be freed by a concurrent upsert or remove, so it is for quiescent
+// use. show, forEach, getOrderedContent, size and clear need the tree to be
+// quiescent.
+template <typename T, size_t Fanout = 32>
+class ConcurrentBPlusTree : public DataStructure<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+
+  static_assert(Fanout >= 4, "ConcurrentBPlusTree needs a fanout of 4+");
+
+  struct OLCNode {
+    std::atomic<uint64_t> version{0};
+    // Elements in a leaf, children in an inner node.
+    std::atomic<uint32_t> count{0};
+    const bool leaf;
+
+    explicit OLCNode(bool leaf) : leaf(leaf) {}
+  };
+
+  struct Leaf : OLCNode {
+    std::atomic<Node<T> *> values[Fanout]{};
+    std::atomic<Leaf *> next{nullptr};
+
+    Leaf() : OLCNode(true) {}
+  };
+
+  // keys[i] is the smallest key reachable through children[i + 1] when it
+  // was split off.
+  struct Inner : OLCNode {
+    std::atomic<Node<T> *> keys[Fanout - 1]{};
+    std::atomic<OLCNode *> children[Fanout]{};
+
+    Inner() : OLCNode(false) {}
+  };
+
+public:
+  ConcurrentBPlusTree() : m_root(new Leaf()) {};
+  ConcurrentBPlusTree(const ConcurrentBPlusTree &) = delete;
+  ConcurrentBPlusTree &operator=(const ConcurrentBPlusTree &) = delete;
+  ~ConcurrentBPlusTree() {
+    _clear(m_root.load());
+    _free_retired();
+  };
+
+  // Data Structure: methods
+  void insert(T value) override {
+    EpochGuard guard(*this);
+    auto keep = [](T &, const T &) {};
+    _insert(value, keep, false);
+  };
+  void remove(T value) override {
+    EpochGuard guard(*this);
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    while (!_try_remove(key))
+      m_restarts.fetch_add(1, std::memory_order_relaxed);
+  };
+
+  // Inserts `value`, or replaces the element already stored under its key
+  // by a copy on which merge(copy, value) was called (e.g. adding the
+  // counts).
+  template <typename Merge> void upsert(T value, Merge merge) {
+    EpochGuard guard(*this);
+    _insert(value, merge, true);
+  }
+
+  bool contains(T k) const override {
+    EpochGuard guard(*this);
+    return _find(KeyExtractor<T>::getKey(k)) != nullptr;
+  };
+
+  // Copies the element stored under the key of `value` into `out`; false
+  // when absent. The copy is taken under the epoch guard from a node that
+  // no writer changes, so it is the element as of the validated leaf read.
+  bool find(const T &value, T &out) const {
+    EpochGuard guard(*this);
+    Node<T> *found = _find(KeyExtractor<T>::getKey(value));
+    if (!found)
+      return false;
+    out = found->key;
+    return true;
+  }
+
+  // Not safe against concurrent writers; see the class comment.
+  Node<T> *getNode(const T &value) override {
+    EpochGuard guard(*this);
+    return _find(KeyExtractor<T>::getKey(value));
+  }
+
+  bool isEmpty() override { return size() == 0; }
+  void clear() override {
+    _clear(m_root.load());
+    _free_retired();
+    m_root.store(new Leaf());
+  }
+
+  int size() {
+    int total = 0;
+    for (Leaf *leaf = _first_leaf(); leaf; leaf = leaf->next.load())
+      total += leaf->count.load();
+    return total;
+  }
+  int height() {
+    int levels = 1;
+    for (OLCNode *node = m_root.load(); !node->leaf;
+         node = static_cast<Inner *>(node)->children[0].load())
+      levels++;
+    return levels;
+  }
+
+  // Optimistic reads and lock attempts that saw a concurrent writer and had
+  // to start over.
+  unsigned long restarts() const { return m_restarts.load(); }
+
+  // Retired elements not freed yet.
+  size_t retired() {
+    std::lock_guard<std::mutex> lock(m_retired_mutex);
+    return m_retired.size();
+  }
+
+  // One line per level, one bracket per node.
+  void show() override {
+    std::queue<OLCNode *> level;
+    level.push(m_root.load());
+    while (!level.empty()) {
+      size_t width = level.size();
+      for (size_t n = 0; n < width; n++) {
+        OLCNode *node = level.front();
+        level.pop();
+        std::cout << "[";
+        if (node->leaf) {
+          Leaf *leaf = static_cast<Leaf *>(node);
+          for (uint32_t i = 0; i < node->count.load(); i++)
+            std::cout << (i ? " " : "") << leaf->values[i].load()->key;
+        } else {
+          Inner *inner = static_cast<Inner *>(node);
+          for (uint32_t i = 0; i + 1 < node->count.load(); i++)
+            std::cout << (i ? " " : "")
+                      << KeyExtractor<T>::getKey(inner->keys[i].load()->key);
+          for (uint32_t i = 0; i < node->count.load(); i++)
+            level.push(inner->children[i].load());
+        }
+        std::cout << "] ";
+      }
+      std::cout << std::endl;
+    }
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    forEach([&result](const T &value) { result.push_back(value); });
+    return result;
+  }
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (Leaf *leaf = _first_leaf(); leaf; leaf = leaf->next.load())
+      for (uint32_t i = 0; i < leaf->count.load(); i++)
+        func(leaf->values[i].load()->key);
+  }
+
+private:
+  // Epoch-based reclamation. Each operation registers in its thread's slot
+  // under the parity of the global epoch. An element is retired with the
+  // epoch read after it was unlinked, so only operations of that epoch or
+  // earlier can hold it. The epoch only advances once the operations of the
+  // previous epoch have drained, so an element is freed once the epoch is
+  // two steps past its own.
+  static constexpr size_t EPOCH_SLOTS = 64;
+  static constexpr size_t RECLAIM_BATCH = 64;
+
+  struct alignas(64) EpochSlot {
+    std::atomic<uint32_t> active[2]{};
+  };
+
+  class EpochGuard {
+  public:
+    explicit EpochGuard(const ConcurrentBPlusTree &tree)
+        : m_slot(tree.m_slots[_slot_index()]) {
+      while (true) {
+        m_epoch = tree.m_epoch.load();
+        m_slot.active[m_epoch & 1].fetch_add(1);
+        // The epoch moved before the registration was seen: register
+        // again, or an advance may have missed this operation.
+        if (tree.m_epoch.load() == m_epoch)
+          return;
+        m_slot.active[m_epoch & 1].fetch_sub(1);
+      }
+    }
+    ~EpochGuard() { m_slot.active[m_epoch & 1].fetch_sub(1); }
+
+  private:
+    EpochSlot &m_slot;
+    uint64_t m_epoch{0};
+
+    // Threads take the slots in turn, so up to EPOCH_SLOTS threads never
+    // write to the same cache line.
+    static size_t _slot_index() {
+      static std::atomic<size_t> next{0};
+      static thread_local size_t index = next.fetch_add(1) % EPOCH_SLOTS;
+      return index;
+    }
+  };
+
+  struct Retired {
+    Node<T> *node;
+    uint64_t epoch;
+  };
+
+  std::atomic<OLCNode *> m_root;
+  mutable std::atomic<unsigned long> m_restarts{0};
+  mutable EpochSlot m_slots[EPOCH_SLOTS];
+  std::atomic<uint64_t> m_epoch{2};
+  std::mutex m_retired_mutex;
+  std::vector<Retired> m_retired;
+  size_t m_reclaim_at{RECLAIM_BATCH};
+
+  // Optimistic lock. Writers add 2 to lock and 2 again to unlock, so any
+  // change leaves the version different from what a reader noted.
+  static uint64_t _read_lock(const OLCNode *node) {
+    uint64_t version = node->version.load(std::memory_order_acquire);
+    while (version & 2) {
+      std::this_thread::yield();
+      version = node->version.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+  static bool _validate(const OLCNode *node, uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return node->version.load(std::memory_order_relaxed) == version;
+  }
+  // Locks `node` if it is still at `version`, i.e. if everything read from
+  // it so far is still true.
+  static bool _upgrade(OLCNode *node, uint64_t version) {
+    return node->version.compare_exchange_strong(version, version + 2,
+                                                 std::memory_order_acquire);
+  }
+  static void _write_unlock(OLCNode *node) {
+    node->version.fetch_add(2, std::memory_order_release);
+  }
+
+  // First of the first `count` slots whose key is greater than `key` (upper)
+  // or not smaller (lower). An empty slot means a writer was caught midway:
+  // `torn` is set and the caller restarts.
+  static uint32_t _search(const std::atomic<Node<T> *> *slots, uint32_t count,
+                          const KeyType &key, bool upper, bool &torn) {
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+      uint32_t mid = lo + (hi - lo) / 2;
+      Node<T> *node = slots[mid].load(std::memory_order_acquire);
+      if (!node) {
+        torn = true;
+        return 0;
+      }
+      const KeyType &slotKey = KeyExtractor<T>::getKey(node->key);
+      bool goRight = upper ? !(key < slotKey) : slotKey < key;
+      if (goRight)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  // A count read without the lock may be torn; it is clamped so the reads
+  // stay in bounds until the version check rejects them.
+  static uint32_t _count(const OLCNode *node, uint32_t capacity) {
+    uint32_t count = node->count.load(std::memory_order_relaxed);
+    return count < capacity ? count : capacity;
+  }
+
+  Node<T> *_find(const KeyType &key) const {
+    while (true) {
+      bool ok = false;
+      Node<T> *found = _try_find(key, ok);
+      if (ok)
+        return found;
+      m_restarts.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  Node<T> *_try_find(const KeyType &key, bool &ok) const {
+    OLCNode *node = m_root.load(std::memory_order_acquire);
+    uint64_t version = _read_lock(node);
+    if (node != m_root.load(std::memory_order_acquire))
+      return nullptr;
+
+    while (!node->leaf) {
+      Inner *inner = static_cast<Inner *>(node);
+      bool torn = false;
+      uint32_t children = _count(inner, Fanout);
+      uint32_t pos = children
+                         ? _search(inner->keys, children - 1, key, true, torn)
+                         : 0;
+      OLCNode *child = inner->children[pos].load(std::memory_order_acquire);
+      if (torn || !child)
+        return nullptr;
+      uint64_t childVersion = _read_lock(child);
+      if (!_validate(inner, version))
+        return nullptr;
+      node = child;
+      version = childVersion;
+    }
+
+    Leaf *leaf = static_cast<Leaf *>(node);
+    bool torn = false;
+    uint32_t count = _count(leaf, Fanout);
+    uint32_t pos = _search(leaf->values, count, key, false, torn);
+    Node<T> *found = pos < count
+                         ? leaf->values[pos].load(std::memory_order_acquire)
+                         : nullptr;
+    if (torn || (pos < count && !found) || !_validate(leaf, version))
+      return nullptr;
+    ok = true;
+    return found && KeyExtractor<T>::getKey(found->key) == key ? found
+                                                               : nullptr;
+  }
+
+  template <typename Merge> void _insert(T &value, Merge &merge, bool merging) {
+    while (!_try_insert(value, merge, merging))
+      m_restarts.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Descends with optimistic reads, splitting full nodes on the way, and
+  // locks only the leaf (or a node and its parent for a split). Returns
+  // false to restart from the root.
+  template <typename Merge>
+  bool _try_insert(T &value, Merge &merge, bool merging) {
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    OLCNode *node = m_root.load(std::memory_order_acquire);
+    uint64_t version = _read_lock(node);
+    if (node != m_root.load(std::memory_order_acquire))
+      return false;
+    Inner *parent = nullptr;
+    uint64_t parentVersion = 0;
+
+    while (!node->leaf) {
+      Inner *inner = static_cast<Inner *>(node);
+      if (inner->count.load(std::memory_order_relaxed) == Fanout) {
+        _split(inner, version, parent, parentVersion);
+        return false;
+      }
+
+      bool torn = false;
+      uint32_t children = _count(inner, Fanout);
+      uint32_t pos = children
+                         ? _search(inner->keys, children - 1, key, true, torn)
+                         : 0;
+      OLCNode *child = inner->children[pos].load(std::memory_order_acquire);
+      if (torn || !child)
+        return false;
+      uint64_t childVersion = _read_lock(child);
+      if (!_validate(inner, version))
+        return false;
+      parent = inner;
+      parentVersion = version;
+      node = child;
+      version = childVersion;
+    }
+
+    Leaf *leaf = static_cast<Leaf *>(node);
+    bool torn = false;
+    uint32_t count = _count(leaf, Fanout);
+    uint32_t pos = _search(leaf->values, count, key, false, torn);
+    Node<T> *existing = pos < count
+                            ? leaf->values[pos].load(std::memory_order_acquire)
+                            : nullptr;
+    if (torn || (pos < count && !existing))
+      return false;
+    bool found = existing && KeyExtractor<T>::getKey(existing->key) == key;
+
+    // A plain insert of a present key writes nothing.
+    if (found && !merging)
+      return _validate(leaf, version);
+    if (!found && count == Fanout) {
+      _split(leaf, version, parent, parentVersion);
+      return false;
+    }
+
+    // Stored elements never change, so the merge is done on a copy before
+    // the lock is taken.
+    Node<T> *merged = nullptr;
+    if (found) {
+      merged = new Node<T>(existing->key);
+      merge(merged->key, value);
+    }
+
+    // The lock is taken at the version the leaf was read at, so `pos` and
+    // `found` still hold.
+    if (!_upgrade(leaf, version)) {
+      delete merged;
+      return false;
+    }
+    if (parent && !_validate(parent, parentVersion)) {
+      _write_unlock(leaf);
+      delete merged;
+      return false;
+    }
+
+    if (found) {
+      leaf->values[pos].store(merged, std::memory_order_release);
+    } else {
+      for (uint32_t i = count; i > pos; i--)
+        leaf->values[i].store(
+            leaf->values[i - 1].load(std::memory_order_relaxed),
+            std::memory_order_release);
+      leaf->values[pos].store(new Node<T>(std::move(value)),
+                              std::memory_order_release);
+      leaf->count.store(count + 1, std::memory_order_relaxed);
+    }
+    _write_unlock(leaf);
+    if (found)
+      _retire(existing);
+    return true;
+  }
+
+  bool _try_remove(const KeyType &key) {
+    OLCNode *node = m_root.load(std::memory_order_acquire);
+    uint64_t version = _read_lock(node);
+    if (node != m_root.load(std::memory_order_acquire))
+      return false;
+    Inner *parent = nullptr;
+    uint64_t parentVersion = 0;
+
+    while (!node->leaf) {
+      Inner *inner = static_cast<Inner *>(node);
+      bool torn = false;
+      uint32_t children = _count(inner, Fanout);
+      uint32_t pos = children
+                         ? _search(inner->keys, children - 1, key, true, torn)
+                         : 0;
+      OLCNode *child = inner->children[pos].load(std::memory_order_acquire);
+      if (torn || !child)
+        return false;
+      uint64_t childVersion = _read_lock(child);
+      if (!_validate(inner, version))
+        return false;
+      parent = inner;
+      parentVersion = version;
+      node = child;
+      version = childVersion;
+    }
+
+    Leaf *leaf = static_cast<Leaf *>(node);
+    bool torn = false;
+    uint32_t count = _count(leaf, Fanout);
+    uint32_t pos = _search(leaf->values, count, key, false, torn);
+    Node<T> *existing = pos < count
+                            ? leaf->values[pos].load(std::memory_order_acquire)
+                            : nullptr;
+    if (torn || (pos < count && !existing))
+      return false;
+    if (!existing || !(KeyExtractor<T>::getKey(existing->key) == key))
+      return _validate(leaf, version);
+
+    if (!_upgrade(leaf, version))
+      return false;
+    if (parent && !_validate(parent, parentVersion)) {
+      _write_unlock(leaf);
+      return false;
+    }
+    for (uint32_t i = pos; i + 1 < count; i++)
+      leaf->values[i].store(leaf->values[i + 1].load(std::memory_order_relaxed),
+                            std::memory_order_release);
+    leaf->count.store(count - 1, std::memory_order_relaxed);
+    _write_unlock(leaf);
+    _retire(existing);
+    return true;
+  }
+
+  // Splits a full node, locking it and its parent (which has room, or it
+  // would have been split first). Gives up silently if either changed since
+  // it was read; the caller restarts either way.
+  void _split(OLCNode *node, uint64_t version, Inner *parent,
+              uint64_t parentVersion) {
+    if (parent && !_upgrade(parent, parentVersion))
+      return;
+    if (!_upgrade(node, version)) {
+      if (parent)
+        _write_unlock(parent);
+      return;
+    }
+    if (!parent && node != m_root.load(std::memory_order_acquire)) {
+      _write_unlock(node);
+      return;
+    }
+
+    Node<T> *separator = nullptr;
+    OLCNode *right;
+    if (node->leaf)
+      right = _split_leaf(static_cast<Leaf *>(node), separator);
+    else
+      right = _split_inner(static_cast<Inner *>(node), separator);
+    if (parent) {
+      _insert_child(parent, separator, right);
+    } else {
+      Inner *root = new Inner();
+      root->children[0].store(node, std::memory_order_relaxed);
+      root->children[1].store(right, std::memory_order_relaxed);
+      root->keys[0].store(separator, std::memory_order_relaxed);
+      root->count.store(2, std::memory_order_relaxed);
+      m_root.store(root, std::memory_order_release);
+    }
+
+    _write_unlock(node);
+    if (parent)
+      _write_unlock(parent);
+  }
+
+  // Moves the upper half of a locked leaf into a new right sibling.
+  static Leaf *_split_leaf(Leaf *leaf, Node<T> *&separator) {
+    Leaf *right = new Leaf();
+    uint32_t count = leaf->count.load(std::memory_order_relaxed);
+    uint32_t half = count / 2;
+    for (uint32_t i = half; i < count; i++)
+      right->values[i - half].store(
+          leaf->values[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    right->count.store(count - half, std::memory_order_relaxed);
+    right->next.store(leaf->next.load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+    leaf->next.store(right, std::memory_order_release);
+    leaf->count.store(half, std::memory_order_relaxed);
+    separator =
+        new Node<T>(right->values[0].load(std::memory_order_relaxed)->key);
+    return right;
+  }
+
+  // Moves the upper half of a locked inner node into a new right sibling;
+  // the key between the halves moves up as `separator`.
+  static Inner *_split_inner(Inner *inner, Node<T> *&separator) {
+    Inner *right = new Inner();
+    uint32_t count = inner->count.load(std::memory_order_relaxed);
+    uint32_t half = count / 2;
+    for (uint32_t i = half; i < count; i++)
+      right->children[i - half].store(
+          inner->children[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    for (uint32_t i = half; i + 1 < count; i++)
+      right->keys[i - half].store(
+          inner->keys[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    right->count.store(count - half, std::memory_order_relaxed);
+    separator = inner->keys[half - 1].load(std::memory_order_relaxed);
+    inner->count.store(half, std::memory_order_relaxed);
+    return right;
+  }
+
+  static void _insert_child(Inner *parent, Node<T> *separator,
+                            OLCNode *child) {
+    uint32_t count = parent->count.load(std::memory_order_relaxed);
+    bool torn = false;
+    uint32_t pos = _search(parent->keys, count - 1,
+                           KeyExtractor<T>::getKey(separator->key), true, torn);
+    for (uint32_t i = count - 1; i > pos; i--)
+      parent->keys[i].store(parent->keys[i - 1].load(std::memory_order_relaxed),
+                            std::memory_order_release);
+    for (uint32_t i = count; i > pos + 1; i--)
+      parent->children[i].store(
+          parent->children[i - 1].load(std::memory_order_relaxed),
+          std::memory_order_release);
+    parent->keys[pos].store(separator, std::memory_order_release);
+    parent->children[pos + 1].store(child, std::memory_order_release);
+    parent->count.store(count + 1, std::memory_order_relaxed);
+  }
+
+  Leaf *_first_leaf() const {
+    OLCNode *node = m_root.load();
+    while (!node->leaf)
+      node = static_cast<Inner *>(node)->children[0].load();
+    return static_cast<Leaf *>(node);
+  }
+
+  static void _clear(OLCNode *node) {
+    if (node->leaf) {
+      Leaf *leaf = static_cast<Leaf *>(node);
+      for (uint32_t i = 0; i < leaf->count.load(); i++)
+        delete leaf->values[i].load();
+      delete leaf;
+      return;
+    }
+    Inner *inner = static_cast<Inner *>(node);
+    for (uint32_t i = 0; i < inner->count.load(); i++)
+      _clear(inner->children[i].load());
+    for (uint32_t i = 0; i + 1 < inner->count.load(); i++)
+      delete inner->keys[i].load();
+    delete inner;
+  }
+
+  void _retire(Node<T> *node) {
+    std::lock_guard<std::mutex> lock(m_retired_mutex);
+    m_retired.push_back({node, m_epoch.load()});
+    if (m_retired.size() >= m_reclaim_at)
+      _reclaim();
+  }
+
+  // Advances the epoch if the operations of the previous one have drained,
+  // then frees what was retired two epochs back. Called with the retired
+  // list locked, so only one thread advances at a time.
+  void _reclaim() {
+    uint64_t epoch = m_epoch.load();
+    bool drained = true;
+    for (const EpochSlot &slot : m_slots)
+      drained = drained && slot.active[(epoch - 1) & 1].load() == 0;
+    if (drained)
+      m_epoch.store(++epoch);
+
+    size_t kept = 0;
+    for (const Retired &retired : m_retired) {
+      if (retired.epoch + 2 <= epoch)
+        delete retired.node;
+      else
+        m_retired[kept++] = retired;
+    }
+    m_retired.resize(kept);
+    // Readers that stay in an old epoch keep elements alive; back off so the
+    // scans stay amortized O(1) per retirement.
+    m_reclaim_at = std::max(RECLAIM_BATCH, 2 * kept);
+  }
+
+  void _free_retired() {
+    for (const Retired &retired : m_retired)
+      delete retired.node;
+    m_retired.clear();
+    m_reclaim_at = RECLAIM_BATCH;
+  }
+};
+
+#endif
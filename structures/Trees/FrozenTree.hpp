@@ -0,0 +1,226 @@
+#ifndef FROZENTREE_HPP
+#define FROZENTREE_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/DataStructure.hpp"
+#include "../../interfaces/core/KeyExtractor.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Keys of a FrozenTree, stored apart from the values so the search only walks
+// a dense array. Generic keys are kept by value in slot order.
+template <typename K> struct FrozenKeyArena {
+  std::vector<K> keys;
+
+  void reserve(size_t count, size_t) { keys.reserve(count); }
+  void push_back(const K &key) { keys.push_back(key); }
+  const K &operator[](size_t slot) const { return keys[slot]; }
+  const void *slotAddress(size_t slot) const { return keys.data() + slot; }
+  void clear() { keys.clear(); }
+};
+
+// Strings are packed back to back in a single buffer and addressed by offset,
+// so a lookup touches the offsets array and a few bytes of the buffer instead
+// of one heap block per key. Offsets are 32-bit to keep that array dense, so
+// the buffer is limited to 4 GiB.
+template <> struct FrozenKeyArena<std::string> {
+  std::string chars;
+  std::vector<uint32_t> offsets{0};
+
+  void reserve(size_t count, size_t bytes) {
+    offsets.reserve(count + 1);
+    chars.reserve(bytes);
+  }
+  void push_back(const std::string &key) {
+    if (key.size() > UINT32_MAX - chars.size())
+      throw std::length_error("FrozenTree string keys exceed 4 GiB");
+    chars += key;
+    offsets.push_back(static_cast<uint32_t>(chars.size()));
+  }
+  std::string_view operator[](size_t slot) const {
+    return std::string_view(chars.data() + offsets[slot],
+                            offsets[slot + 1] - offsets[slot]);
+  }
+  const void *slotAddress(size_t slot) const { return offsets.data() + slot; }
+  void clear() {
+    chars.clear();
+    offsets.assign(1, 0);
+  }
+};
+
+// Splits an element into its key, which goes to the FrozenKeyArena, and the
+// mapped part kept per slot, and puts the two back together on the way out.
+// An element that is its own key has nothing mapped.
+template <typename T> struct FrozenSlot {
+  struct Mapped {};
+  static Mapped mapped(const T &) { return {}; }
+  template <typename K> static T rebuild(const K &key, Mapped) {
+    return T(key);
+  }
+};
+
+template <typename K, typename V> struct FrozenSlot<std::pair<K, V>> {
+  using Mapped = V;
+  static const V &mapped(const std::pair<K, V> &pair) { return pair.second; }
+  template <typename KeyView>
+  static std::pair<K, V> rebuild(const KeyView &key, const V &mapped) {
+    return {K(key), mapped};
+  }
+};
+
+// Immutable, pointer-free copy of an ordered structure. Elements are laid out
+// in Eytzinger (BFS) order: slot k has its children at 2k and 2k + 1, so the
+// top levels of the implicit tree share a handful of cache lines and the
+// descent needs no pointer loads. Only the mapped part of each element (the
+// count, for word pairs) is stored per slot; elements are rebuilt from the key
+// arena on the way out. Built by AVLTree::freeze/RedBlack::freeze.
+template <typename T> class FrozenTree : public DataStructure<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+  using Key = std::decay_t<KeyType>;
+  using Slot = FrozenSlot<T>;
+
+public:
+  FrozenTree() {};
+  explicit FrozenTree(const std::vector<T> &sorted) { _build(sorted); }
+
+  void insert(T value) override {
+    throw std::logic_error("FrozenTree is immutable");
+  }
+  void remove(T value) override {
+    throw std::logic_error("FrozenTree is immutable");
+  }
+
+  bool contains(T k) const override {
+    return _lower_bound(KeyExtractor<T>::getKey(k)) != NOT_FOUND;
+  }
+
+  // Frozen elements are not Node<T>s; use find() for lookups.
+  Node<T> *getNode(const T &value) override { return nullptr; }
+
+  // Copies the element matching value's key into out.
+  bool find(const T &value, T &out) const {
+    size_t slot = _lower_bound(KeyExtractor<T>::getKey(value));
+    if (slot == NOT_FOUND)
+      return false;
+    out = _element(slot);
+    return true;
+  }
+
+  bool isEmpty() override { return m_mapped.empty(); }
+  int size() const { return static_cast<int>(m_mapped.size()); }
+
+  void show() override {
+    _in_order([](const T &value) { std::cout << value << "\n"; });
+  }
+
+  void clear() override {
+    m_mapped.clear();
+    m_keys.clear();
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    result.reserve(m_mapped.size());
+    _in_order([&result](const T &value) { result.push_back(value); });
+    return result;
+  }
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    for (size_t slot = 0; slot < m_mapped.size(); slot++)
+      func(_element(slot));
+  }
+
+private:
+  static constexpr size_t NOT_FOUND = static_cast<size_t>(-1);
+
+  // Slot k (1-based) of the implicit tree lives at index k - 1.
+  std::vector<typename Slot::Mapped> m_mapped;
+  FrozenKeyArena<Key> m_keys;
+
+  T _element(size_t slot) const {
+    return Slot::rebuild(m_keys[slot], m_mapped[slot]);
+  }
+
+  void _build(const std::vector<T> &sorted) {
+    size_t n = sorted.size();
+    std::vector<size_t> order(n + 1);
+    size_t next = 0;
+    _fill(order, next, 1, n);
+
+    size_t bytes = 0;
+    for (const T &value : sorted)
+      bytes += _key_bytes(KeyExtractor<T>::getKey(value));
+
+    m_mapped.reserve(n);
+    m_keys.reserve(n, bytes);
+    for (size_t k = 1; k <= n; k++) {
+      m_mapped.push_back(Slot::mapped(sorted[order[k]]));
+      m_keys.push_back(KeyExtractor<T>::getKey(sorted[order[k]]));
+    }
+  }
+
+  // In-order walk of the implicit tree assigning sorted positions to slots.
+  void _fill(std::vector<size_t> &order, size_t &next, size_t k, size_t n) {
+    if (k > n)
+      return;
+    _fill(order, next, 2 * k, n);
+    order[k] = next++;
+    _fill(order, next, 2 * k + 1, n);
+  }
+
+  static size_t _key_bytes(const std::string &key) { return key.size(); }
+  template <typename K> static size_t _key_bytes(const K &) { return 0; }
+
+  // Branch-free descent: the comparison result picks the child, and the
+  // trailing ones of k (the right turns taken after the last left turn) are
+  // shifted away to recover the lower bound.
+  size_t _lower_bound(const KeyType &key) const {
+    size_t n = m_mapped.size();
+    size_t k = 1;
+
+    while (k <= n) {
+      __builtin_prefetch(m_keys.slotAddress(std::min(16 * k, n) - 1));
+      PERF_TRACKER.incrementComparisons();
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      k = 2 * k + (m_keys[k - 1] < key);
+    }
+    k >>= __builtin_ffsll(~k);
+
+    if (k == 0 || key < m_keys[k - 1])
+      return NOT_FOUND;
+    return k - 1;
+  }
+
+  template <typename Func> void _in_order(Func func) const {
+    size_t n = m_mapped.size();
+    if (n == 0)
+      return;
+
+    size_t k = 1;
+    while (2 * k <= n)
+      k *= 2;
+
+    while (k) {
+      func(_element(k - 1));
+
+      if (2 * k + 1 <= n) {
+        k = 2 * k + 1;
+        while (2 * k <= n)
+          k *= 2;
+      } else {
+        while (k & 1)
+          k >>= 1;
+        k >>= 1;
+      }
+    }
+  }
+};
+
+#endif
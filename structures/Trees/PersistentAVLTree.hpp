@@ -0,0 +1,382 @@
+#ifndef PERSISTENTAVLTREE_HPP
+#define PERSISTENTAVLTREE_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/DataStructure.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Node of a PersistentAVLTree. Children are shared between versions, so a
+// node is never changed once a version that reaches it has been published;
+// `epoch` tells the writer which nodes are still private to it.
+template <typename T> struct PersistentNode {
+  T key;
+  unsigned int height{1};
+  unsigned int size{1};
+  uint64_t epoch;
+  std::shared_ptr<PersistentNode> left;
+  std::shared_ptr<PersistentNode> right;
+
+  PersistentNode(T key, uint64_t epoch) : key(std::move(key)), epoch(epoch) {}
+};
+
+// AVL tree with path copying: a write copies the nodes on the path from the
+// root to the change and shares every other subtree with the previous
+// version, so old versions stay intact and readable.
+//
+// One writer thread calls insert/remove/upsert and, whenever its changes
+// should become visible, publish(). Any thread may call snapshot(), which is
+// O(1): it atomically loads the last published root. A Version is immutable
+// and is searched and iterated without locks while the writer goes on, and
+// the nodes only it still reaches are freed when the last Version holding
+// them is dropped (reference counting).
+//
+// Between two publishes the writer updates its own new nodes in place: a
+// node whose epoch is the current one is reachable from no published root.
+// A block of insertions therefore copies each shared node at most once,
+// instead of once per insertion.
+//
+// getNode() returns nullptr: handing out a mutable node would change the
+// published versions. Counts are updated with upsert().
+template <typename T> class PersistentAVLTree : public DataStructure<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+  using NodePtr = std::shared_ptr<PersistentNode<T>>;
+
+public:
+  // Read-only view of the tree as of one publish().
+  class Version {
+  public:
+    Version() = default;
+
+    bool contains(const T &value) const {
+      return find(value) != nullptr;
+    }
+    // The element with the key of `value`, valid while this Version lives.
+    const T *find(const T &value) const {
+      const PersistentNode<T> *node =
+          _find(m_root.get(), KeyExtractor<T>::getKey(value));
+      return node ? &node->key : nullptr;
+    }
+    bool isEmpty() const { return !m_root; }
+    int size() const { return _size(m_root.get()); }
+
+    // In-order traversal.
+    template <typename Func> void forEach(Func &&func) const {
+      _in_order(m_root.get(), func);
+    }
+    std::vector<std::pair<std::string, int>> getOrderedContent() const {
+      std::vector<std::pair<std::string, int>> result;
+      forEach([&result](const T &value) { result.push_back(value); });
+      return result;
+    }
+
+  private:
+    friend class PersistentAVLTree;
+    explicit Version(std::shared_ptr<const PersistentNode<T>> root)
+        : m_root(std::move(root)) {}
+
+    std::shared_ptr<const PersistentNode<T>> m_root;
+  };
+
+  PersistentAVLTree() {};
+  ~PersistentAVLTree() {};
+
+  // Data Structure: methods
+  void insert(T value) override {
+    bool inserted = false;
+    m_root = _insert(m_root, std::move(value), inserted);
+  };
+  void remove(T value) override {
+    bool removed = false;
+    m_root = _remove(m_root, KeyExtractor<T>::getKey(value), removed);
+  };
+
+  // Inserts `value`, or calls merge(existing, value) on the element already
+  // stored under its key (e.g. adding the counts).
+  template <typename Merge> void upsert(T value, Merge merge) {
+    bool inserted = false;
+    m_root = _upsert(m_root, std::move(value), merge, inserted);
+  }
+
+  // Makes the writer's changes visible to snapshot().
+  void publish() {
+    std::atomic_store(&m_published,
+                      std::shared_ptr<const PersistentNode<T>>(m_root));
+    m_epoch++;
+  }
+
+  // The last published version. Safe to call from any thread.
+  Version snapshot() const { return Version(std::atomic_load(&m_published)); }
+
+  // The methods below read the writer's working version: writer thread only.
+  bool contains(T k) const override {
+    return _find(m_root.get(), KeyExtractor<T>::getKey(k)) != nullptr;
+  };
+  // Element stored under the key of `value`, nullptr when absent.
+  const T *find(const T &value) const {
+    const PersistentNode<T> *node =
+        _find(m_root.get(), KeyExtractor<T>::getKey(value));
+    return node ? &node->key : nullptr;
+  }
+
+  bool isEmpty() override { return !m_root; };
+  // Drops the working version; published versions are unaffected.
+  void clear() override { m_root = nullptr; };
+  Node<T> *getNode(const T &value) override { return nullptr; }
+
+  int size() { return _size(m_root.get()); };
+  int height() { return m_root ? m_root->height : 0; };
+  void show() override { _show(m_root.get(), ""); };
+
+  void forEach(const typename DataStructure<T>::Visitor &func) const override {
+    _in_order(m_root.get(), func);
+  }
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    _in_order(m_root.get(),
+              [&result](const T &value) { result.push_back(value); });
+    return result;
+  }
+
+  // Replaces the working version with a perfectly balanced tree built in
+  // O(n) from elements sorted by key without duplicates.
+  void buildFromSorted(const std::vector<T> &sorted) {
+    m_root = _build(sorted, 0, sorted.size());
+  }
+
+private:
+  NodePtr m_root;
+  std::shared_ptr<const PersistentNode<T>> m_published;
+  uint64_t m_epoch{0};
+
+  static int _size(const PersistentNode<T> *node) {
+    return node ? node->size : 0;
+  }
+  static unsigned int _height(const NodePtr &node) {
+    return node ? node->height : 0;
+  }
+  static int _balance_factor(const NodePtr &node) {
+    return static_cast<int>(_height(node->left)) -
+           static_cast<int>(_height(node->right));
+  }
+  static void _update(const NodePtr &node) {
+    node->height = 1 + std::max(_height(node->left), _height(node->right));
+    node->size = 1 + _size(node->left.get()) + _size(node->right.get());
+  }
+
+  NodePtr _make(T value) {
+    return std::make_shared<PersistentNode<T>>(std::move(value), m_epoch);
+  }
+
+  // `node` itself when only the writer can reach it, otherwise a copy that
+  // shares its children.
+  NodePtr _own(const NodePtr &node) {
+    if (node->epoch == m_epoch)
+      return node;
+    NodePtr copy = _make(node->key);
+    copy->height = node->height;
+    copy->size = node->size;
+    copy->left = node->left;
+    copy->right = node->right;
+    return copy;
+  }
+
+  // Rotations on an owned node; the child that moves up is owned first.
+  NodePtr _rotate_right(NodePtr node) {
+    PERF_TRACKER.incrementRotations();
+    NodePtr pivot = _own(node->left);
+    node->left = pivot->right;
+    _update(node);
+    pivot->right = std::move(node);
+    _update(pivot);
+    return pivot;
+  }
+  NodePtr _rotate_left(NodePtr node) {
+    PERF_TRACKER.incrementRotations();
+    NodePtr pivot = _own(node->right);
+    node->right = pivot->left;
+    _update(node);
+    pivot->left = std::move(node);
+    _update(pivot);
+    return pivot;
+  }
+
+  // Restores the AVL invariant at an owned node whose children changed.
+  NodePtr _rebalance(NodePtr node) {
+    _update(node);
+    int balance = _balance_factor(node);
+    if (balance > 1) {
+      if (_balance_factor(node->left) < 0)
+        node->left = _rotate_left(_own(node->left));
+      return _rotate_right(std::move(node));
+    }
+    if (balance < -1) {
+      if (_balance_factor(node->right) > 0)
+        node->right = _rotate_right(_own(node->right));
+      return _rotate_left(std::move(node));
+    }
+    return node;
+  }
+
+  static const PersistentNode<T> *_find(const PersistentNode<T> *node,
+                                        const KeyType &key) {
+    while (node) {
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key == nodeKey)
+        return node;
+      node = key < nodeKey ? node->left.get() : node->right.get();
+    }
+    return nullptr;
+  }
+
+  // Returns the new root of the subtree; an unchanged subtree is returned
+  // as is, without copying its path.
+  NodePtr _insert(const NodePtr &node, T &&value, bool &inserted) {
+    if (!node) {
+      inserted = true;
+      return _make(std::move(value));
+    }
+
+    PERF_TRACKER.incrementNodesVisited();
+    PERF_TRACKER.incrementComparisons();
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+    if (key == nodeKey)
+      return node;
+
+    bool goLeft = key < nodeKey;
+    NodePtr child =
+        _insert(goLeft ? node->left : node->right, std::move(value), inserted);
+    if (!inserted)
+      return node;
+
+    NodePtr owned = _own(node);
+    (goLeft ? owned->left : owned->right) = std::move(child);
+    return _rebalance(std::move(owned));
+  }
+
+  template <typename Merge>
+  NodePtr _upsert(const NodePtr &node, T &&value, Merge &merge,
+                  bool &inserted) {
+    if (!node) {
+      inserted = true;
+      return _make(std::move(value));
+    }
+
+    PERF_TRACKER.incrementNodesVisited();
+    PERF_TRACKER.incrementComparisons();
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+    if (key == nodeKey) {
+      NodePtr owned = _own(node);
+      merge(owned->key, value);
+      return owned;
+    }
+
+    bool goLeft = key < nodeKey;
+    NodePtr child = _upsert(goLeft ? node->left : node->right,
+                            std::move(value), merge, inserted);
+    // An owned child may come back as the same pointer but changed in
+    // place, so the pointer only tells that nothing changed above a merge.
+    if (!inserted && child == (goLeft ? node->left : node->right))
+      return node;
+
+    NodePtr owned = _own(node);
+    (goLeft ? owned->left : owned->right) = std::move(child);
+    if (!inserted)
+      return owned;
+    return _rebalance(std::move(owned));
+  }
+
+  NodePtr _remove(const NodePtr &node, const KeyType &key, bool &removed) {
+    if (!node)
+      return node;
+
+    PERF_TRACKER.incrementNodesVisited();
+    PERF_TRACKER.incrementComparisons();
+    const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+    if (key == nodeKey) {
+      removed = true;
+      PERF_TRACKER.incrementDeletionFixups();
+      if (!node->left)
+        return node->right;
+      if (!node->right)
+        return node->left;
+
+      NodePtr owned = _own(node);
+      owned->right = _remove_min(owned->right, owned->key);
+      return _rebalance(std::move(owned));
+    }
+
+    bool goLeft = key < nodeKey;
+    NodePtr child = _remove(goLeft ? node->left : node->right, key, removed);
+    if (!removed)
+      return node;
+
+    NodePtr owned = _own(node);
+    (goLeft ? owned->left : owned->right) = std::move(child);
+    return _rebalance(std::move(owned));
+  }
+
+  // Unlinks the smallest element of a non-empty subtree into `out`.
+  NodePtr _remove_min(const NodePtr &node, T &out) {
+    if (!node->left) {
+      out = node->key;
+      return node->right;
+    }
+    NodePtr owned = _own(node);
+    owned->left = _remove_min(owned->left, out);
+    return _rebalance(std::move(owned));
+  }
+
+  NodePtr _build(const std::vector<T> &sorted, size_t lo, size_t hi) {
+    if (lo >= hi)
+      return nullptr;
+    size_t mid = lo + (hi - lo) / 2;
+    NodePtr node = _make(sorted[mid]);
+    node->left = _build(sorted, lo, mid);
+    node->right = _build(sorted, mid + 1, hi);
+    _update(node);
+    return node;
+  }
+
+  template <typename Func>
+  static void _in_order(const PersistentNode<T> *node, Func &&func) {
+    std::vector<const PersistentNode<T> *> stack;
+    while (node || !stack.empty()) {
+      for (; node; node = node->left.get())
+        stack.push_back(node);
+      node = stack.back();
+      stack.pop_back();
+      func(node->key);
+      node = node->right.get();
+    }
+  }
+
+  static void _show(const PersistentNode<T> *node, std::string heranca) {
+    if (node != nullptr && (node->left || node->right))
+      _show(node->right.get(), heranca + "r");
+
+    for (int i = 0; i < (int)heranca.size() - 1; i++)
+      std::cout << (heranca[i] != heranca[i + 1] ? "│   " : "    ");
+
+    if (!heranca.empty())
+      std::cout << (heranca.back() == 'r' ? "┌───" : "└───");
+
+    if (node == nullptr) {
+      std::cout << "#\n";
+      return;
+    }
+    std::cout << node->key << std::endl;
+
+    if (node->left || node->right)
+      _show(node->left.get(), heranca + "l");
+  }
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "../../interfaces/core/Node.hpp"
 #include "../../interfaces/enum/NodeColor.hpp"
 #include "../../interfaces/trees/rotatable/RotatableTree.hpp"
+#include "FrozenTree.hpp"
 #include "contexts/RedBlack/DeletionContext.hpp"
 #include "contexts/RedBlack/InsertionContext.hpp"
 #include "contexts/RedBlack/RotationContext.hpp"
@@ -27,7 +28,9 @@ public:
   ~RedBlack() { clear(); };
 
   // Data Structure: methods
-  void insert(T value) override { m_root = _insert(m_root, value); }
+  void insert(T value) override {
+    m_root = _insert(m_root, value);
+  }
 
   void remove(T value) override {
     m_root = _remove(m_root, KeyExtractor<T>::getKey(value));
@@ -62,26 +65,51 @@ public:
   };
 
   // - others datastructures methods.
-  bool isEmpty() override { return !_size(m_root); };
-  void clear() override { m_root = _clear(m_root); };
+  bool isEmpty() override { return !m_root; };
+  void clear() override {
+    m_root = _clear(m_root);
+  };
 
   // Tree methods
-  int size() override { return _size(m_root); };
+  int size() override { return subtree_size(m_root); };
   int height() override { return _tree_height(m_root); };
   void BFS() override { _BFS(m_root); };
   Node<T> *getRoot() const override { return m_root; }
   Node<T> *&getRootRef() override { return m_root; }
+  // The caller may change the count through the returned node and report
+  // it with countChanged.
   Node<T> *getNode(const T &value) override {
     KeyType key = KeyExtractor<T>::getKey(value);
     return _contains(m_root, key);
   }
 
-  std::vector<T> getOrderedContent() const override {
-    std::vector<T> result;
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
     this->in_order([&result](Node<T> *node) { result.push_back(node->key); });
     return result;
   }
 
+  // Replaces the content with a perfectly balanced tree built in O(n) from
+  // elements sorted by key without duplicates. Every level but the last is
+  // full, so coloring only the last one red (when it is incomplete) keeps the
+  // black height equal on all paths.
+  void buildFromSorted(const std::vector<T> &sorted) {
+    clear();
+    size_t fullLevels = 0;
+    while ((size_t{2} << fullLevels) - 1 <= sorted.size())
+      fullLevels++;
+    m_root = build_balanced<T>(sorted, 0, sorted.size(), nullptr, 0,
+                               fullLevels);
+  }
+
+  // Immutable, pointer-free copy for read-mostly phases.
+  FrozenTree<T> freeze() const {
+    std::vector<T> sorted;
+    sorted.reserve(subtree_size(m_root));
+    this->in_order([&sorted](Node<T> *node) { sorted.push_back(node->key); });
+    return FrozenTree<T>(sorted);
+  }
+
 private:
   Node<T> *m_root{nullptr};
 
@@ -107,9 +135,9 @@ private:
       return m_root = new Node<T>(value, BLACK);
     }
 
-    InsertionCtx ctx(new Node<T>(value), m_root);
-    ctx.useCaseAction();
-    ctx.fixupAction();
+    Node<T> *inserted = new Node<T>(value);
+    InsertionCtx ctx(inserted, m_root);
+    ctx.run([inserted] { update_subtree_size_upwards(inserted->parent); });
 
     return m_root;
   }
@@ -125,6 +153,8 @@ private:
     Node<T> *actualNodeBeingDeleted = nodeToDelete;
     Node<T> *replacementNode = nullptr;
     NodeColor originalColor = actualNodeBeingDeleted->color;
+    // Lowest node whose subtree lost an element.
+    Node<T> *resizeFrom = nodeToDelete->parent;
 
     if (!nodeToDelete->left) {
       replacementNode = nodeToDelete->right;
@@ -137,6 +167,10 @@ private:
       originalColor = actualNodeBeingDeleted->color;
       replacementNode = actualNodeBeingDeleted->right;
 
+      resizeFrom = actualNodeBeingDeleted->parent == nodeToDelete
+                       ? actualNodeBeingDeleted
+                       : actualNodeBeingDeleted->parent;
+
       if (actualNodeBeingDeleted->parent == nodeToDelete) {
         if (replacementNode)
           replacementNode->parent = actualNodeBeingDeleted;
@@ -155,6 +189,7 @@ private:
     }
 
     delete nodeToDelete;
+    update_subtree_size_upwards(resizeFrom);
 
     if (originalColor == BLACK && replacementNode) {
       _delete_fixup(replacementNode);
@@ -197,7 +232,7 @@ private:
           currentNode->parent->color = RED;
           PERF_TRACKER.incrementColorChanges(); // sibling
           PERF_TRACKER.incrementColorChanges(); // parent
-          _rotate_left(currentNode->parent);
+          _rotate_left(currentNode->parent, m_root);
           siblingNode = currentNode->parent->right;
         }
 
@@ -215,7 +250,7 @@ private:
             }
             siblingNode->color = RED;
             PERF_TRACKER.incrementColorChanges();
-            _rotate_right(siblingNode);
+            _rotate_right(siblingNode, m_root);
             siblingNode = currentNode->parent->right;
           }
 
@@ -227,7 +262,7 @@ private:
             siblingNode->right->color = BLACK;
             PERF_TRACKER.incrementColorChanges();
           }
-          _rotate_left(currentNode->parent);
+          _rotate_left(currentNode->parent, m_root);
           currentNode = m_root;
         } else {
           break;
@@ -240,7 +275,7 @@ private:
           currentNode->parent->color = RED;
           PERF_TRACKER.incrementColorChanges(); // sibling
           PERF_TRACKER.incrementColorChanges(); // parent
-          _rotate_right(currentNode->parent);
+          _rotate_right(currentNode->parent, m_root);
           siblingNode = currentNode->parent->left;
         }
 
@@ -258,7 +293,7 @@ private:
             }
             siblingNode->color = RED;
             PERF_TRACKER.incrementColorChanges();
-            _rotate_left(siblingNode);
+            _rotate_left(siblingNode, m_root);
             siblingNode = currentNode->parent->left;
           }
 
@@ -270,7 +305,7 @@ private:
             siblingNode->left->color = BLACK;
             PERF_TRACKER.incrementColorChanges();
           }
-          _rotate_right(currentNode->parent);
+          _rotate_right(currentNode->parent, m_root);
           currentNode = m_root;
         } else {
           break;
@@ -389,13 +424,6 @@ private:
     }
     std::cout << std::endl;
   }
-
-  int _size(Node<T> *node) {
-    if (node == nullptr)
-      return 0;
-
-    return 1 + _size(node->left) + _size(node->right);
-  }
 };
 
 #endif
@@ -0,0 +1,440 @@
+#ifndef SPLAYTREE_HPP
+#define SPLAYTREE_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/Node.hpp"
+#include "../../interfaces/trees/rotatable/RotatableTree.hpp"
+#include "FrozenTree.hpp"
+#include "contexts/SplayTree/RotationContext.hpp"
+#include "utils/treeUtils.cpp"
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Self-adjusting search tree with top-down splaying: every access moves the
+// key to the root, so frequently used keys (the few words that take most of
+// the hits in a text) stay a couple of levels deep, at O(log n) amortized
+// per operation.
+//
+// With a splayPeriod greater than 1 it becomes a semi-splay tree: only one
+// in splayPeriod insertions and lookups restructures the tree, the others
+// are plain descents. Hot keys are still splayed often enough to stay near
+// the root, at a fraction of the rotations. Removals always splay.
+//
+// contains() is const and never splays; getNode() does.
+template <typename T,
+          template <typename> class RotationCtx = SplayRotationContext>
+class SplayTree : public RotatableTree<T, RotationCtx> {
+  using Base = RotatableTree<T, RotationCtx>;
+  using Base::_rotate_left;
+  using Base::_rotate_right;
+
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+
+public:
+  explicit SplayTree(unsigned int splayPeriod = 1)
+      : m_splay_period(splayPeriod ? splayPeriod : 1) {};
+  ~SplayTree() { clear(); };
+
+  // Data Structure: methods
+  void insert(T value) override {
+    _insert(std::move(value));
+  };
+  void remove(T value) override {
+    _remove(KeyExtractor<T>::getKey(value));
+  };
+
+  // - maximum and minimum
+  T minimum() override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    return _minimum(m_root)->key;
+  };
+  T maximum() override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    return _maximum(m_root)->key;
+  };
+
+  // - successor and predecessor.
+  T successor(T value) override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    Node<T> *node = _find(m_root, KeyExtractor<T>::getKey(value));
+    Node<T> *succ = node ? _next(node) : nullptr;
+    if (succ == nullptr)
+      throw std::runtime_error("No successor exists for this value");
+    return succ->key;
+  };
+  T predecessor(T value) override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    Node<T> *node = _find(m_root, KeyExtractor<T>::getKey(value));
+    Node<T> *pred = node ? _prev(node) : nullptr;
+    if (pred == nullptr)
+      throw std::runtime_error("No predecessor exists for this value");
+    return pred->key;
+  };
+
+  // - others datastructures methods.
+  bool contains(T k) const override {
+    return _find(m_root, KeyExtractor<T>::getKey(k)) != nullptr;
+  };
+
+  bool isEmpty() override { return !m_root; };
+  void clear() override {
+    _clear(m_root);
+    m_root = nullptr;
+  };
+
+  // Tree methods
+  int size() override { return subtree_size(m_root); };
+  int height() override { return _tree_height(m_root); };
+  void BFS() override { _BFS(m_root); };
+  Node<T> *getRoot() const override { return m_root; }
+  Node<T> *&getRootRef() override { return m_root; }
+  // Splays the key (when sampled); the caller may change the count through
+  // the returned node and report it with countChanged.
+  Node<T> *getNode(const T &value) override {
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    if (!_sampled())
+      return _find(m_root, key);
+    _splay(key);
+    return m_root && KeyExtractor<T>::getKey(m_root->key) == key ? m_root
+                                                                 : nullptr;
+  }
+
+  // Iterative over the parent links: sorted insertions leave a splay tree as
+  // a single path, too deep for the recursive traversal.
+  void in_order(const typename Tree<T>::Callback &func) const override {
+    for (Node<T> *node = m_root ? _minimum(m_root) : nullptr; node;
+         node = _next(node))
+      func(node);
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    in_order([&result](Node<T> *node) { result.push_back(node->key); });
+    return result;
+  }
+
+  // Replaces the content with a perfectly balanced tree built in O(n) from
+  // elements sorted by key without duplicates.
+  void buildFromSorted(const std::vector<T> &sorted) {
+    clear();
+    m_root = build_balanced<T>(sorted, 0, sorted.size(), nullptr, 0,
+                               static_cast<size_t>(-1));
+  }
+
+  // Immutable, pointer-free copy for read-mostly phases.
+  FrozenTree<T> freeze() const {
+    std::vector<T> sorted;
+    sorted.reserve(subtree_size(m_root));
+    in_order([&sorted](Node<T> *node) { sorted.push_back(node->key); });
+    return FrozenTree<T>(sorted);
+  }
+
+private:
+  Node<T> *m_root{nullptr};
+  unsigned int m_splay_period;
+  unsigned int m_accesses{0};
+
+  // Whether this access splays: always for a splay tree, one in
+  // m_splay_period for a semi-splay tree.
+  bool _sampled() {
+    if (m_splay_period == 1)
+      return true;
+    if (++m_accesses < m_splay_period)
+      return false;
+    m_accesses = 0;
+    return true;
+  }
+
+  static Node<T> *_find(Node<T> *node, const KeyType &key) {
+    while (node) {
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      PERF_TRACKER.incrementComparisons();
+
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key == nodeKey)
+        return node;
+      node = key < nodeKey ? node->left : node->right;
+    }
+    return nullptr;
+  }
+
+  // Top-down splay (Sleator and Tarjan): one descent that hangs the nodes
+  // passed on the left of the search path on a left tree and the others on a
+  // right tree, rotating at every zig-zig step, then reassembles them under
+  // the last node reached, which becomes the root. The subtrees hung on the
+  // inner spines of the two trees are only complete once the descent ends,
+  // so the spines are summarized afterwards, bottom-up.
+  void _splay(const KeyType &key) {
+    Node<T> *node = m_root;
+    if (!node)
+      return;
+
+    // Right spine of the left tree and left spine of the right tree.
+    Node<T> *leftRoot = nullptr, *leftMax = nullptr;
+    Node<T> *rightRoot = nullptr, *rightMin = nullptr;
+
+    auto linkLeft = [&](Node<T> *link) {
+      if (leftMax) {
+        leftMax->right = link;
+        link->parent = leftMax;
+      } else {
+        leftRoot = link;
+      }
+      leftMax = link;
+    };
+    auto linkRight = [&](Node<T> *link) {
+      if (rightMin) {
+        rightMin->left = link;
+        link->parent = rightMin;
+      } else {
+        rightRoot = link;
+      }
+      rightMin = link;
+    };
+
+    while (true) {
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      PERF_TRACKER.incrementComparisons();
+
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key < nodeKey) {
+        if (!node->left)
+          break;
+        PERF_TRACKER.incrementComparisons();
+        if (key < KeyExtractor<T>::getKey(node->left->key)) {
+          node = _rotate_right(node, node);
+          if (!node->left)
+            break;
+        }
+        linkRight(node);
+        node = node->left;
+      } else if (nodeKey < key) {
+        if (!node->right)
+          break;
+        PERF_TRACKER.incrementComparisons();
+        if (KeyExtractor<T>::getKey(node->right->key) < key) {
+          node = _rotate_left(node, node);
+          if (!node->right)
+            break;
+        }
+        linkLeft(node);
+        node = node->right;
+      } else {
+        break;
+      }
+    }
+
+    if (leftMax) {
+      leftMax->right = node->left;
+      if (node->left)
+        node->left->parent = leftMax;
+      node->left = leftRoot;
+      leftRoot->parent = node;
+    }
+    if (rightMin) {
+      rightMin->left = node->right;
+      if (node->right)
+        node->right->parent = rightMin;
+      node->right = rightRoot;
+      rightRoot->parent = node;
+    }
+    for (Node<T> *spine = leftMax; spine && spine != node;
+         spine = spine->parent)
+      update_subtree_size(spine);
+    for (Node<T> *spine = rightMin; spine && spine != node;
+         spine = spine->parent)
+      update_subtree_size(spine);
+    update_subtree_size(node);
+    node->parent = nullptr;
+    m_root = node;
+  }
+
+  // Splays the key and, when it is absent, splits the tree around the new
+  // root: the old root is the key's neighbor, so one of its subtrees moves
+  // under the new node.
+  void _insert(T value) {
+    if (!m_root) {
+      m_root = new Node<T>(std::move(value));
+      return;
+    }
+    if (!_sampled()) {
+      _insert_leaf(std::move(value));
+      return;
+    }
+
+    _splay(KeyExtractor<T>::getKey(value));
+    const KeyType &rootKey = KeyExtractor<T>::getKey(m_root->key);
+    if (KeyExtractor<T>::getKey(value) == rootKey)
+      return;
+    bool goLeft = KeyExtractor<T>::getKey(value) < rootKey;
+
+    Node<T> *node = new Node<T>(std::move(value));
+    Node<T> *root = m_root;
+    if (goLeft) {
+      node->left = root->left;
+      node->right = root;
+      root->left = nullptr;
+    } else {
+      node->right = root->right;
+      node->left = root;
+      root->right = nullptr;
+    }
+    if (node->left)
+      node->left->parent = node;
+    if (node->right)
+      node->right->parent = node;
+    update_subtree_size(root);
+    update_subtree_size(node);
+    m_root = node;
+  }
+
+  // Plain insertion at a leaf, for the accesses a semi-splay tree skips.
+  void _insert_leaf(T value) {
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    Node<T> *parent = nullptr;
+    bool goLeft = false;
+
+    for (Node<T> *node = m_root; node;) {
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key < nodeKey) {
+        goLeft = true;
+      } else if (nodeKey < key) {
+        goLeft = false;
+      } else {
+        return;
+      }
+      parent = node;
+      node = goLeft ? node->left : node->right;
+    }
+
+    Node<T> *node = new Node<T>(std::move(value));
+    node->parent = parent;
+    (goLeft ? parent->left : parent->right) = node;
+    update_subtree_size_upwards(parent);
+  }
+
+  // Splays the key to the root, then joins its subtrees by splaying the same
+  // key in the left one: its maximum comes up with no right child.
+  void _remove(const KeyType &key) {
+    _splay(key);
+    if (!m_root || !(KeyExtractor<T>::getKey(m_root->key) == key))
+      return;
+
+    Node<T> *removed = m_root;
+    Node<T> *right = removed->right;
+    m_root = removed->left;
+    if (m_root) {
+      m_root->parent = nullptr;
+      _splay(key);
+      m_root->right = right;
+      if (right)
+        right->parent = m_root;
+      update_subtree_size(m_root);
+    } else {
+      m_root = right;
+      if (m_root)
+        m_root->parent = nullptr;
+    }
+    delete removed;
+  }
+
+  static Node<T> *_minimum(Node<T> *node) {
+    while (node->left)
+      node = node->left;
+    return node;
+  }
+
+  static Node<T> *_maximum(Node<T> *node) {
+    while (node->right)
+      node = node->right;
+    return node;
+  }
+
+  static Node<T> *_next(Node<T> *node) {
+    if (node->right)
+      return _minimum(node->right);
+    while (node->parent && node->parent->right == node)
+      node = node->parent;
+    return node->parent;
+  }
+
+  static Node<T> *_prev(Node<T> *node) {
+    if (node->left)
+      return _maximum(node->left);
+    while (node->parent && node->parent->left == node)
+      node = node->parent;
+    return node->parent;
+  }
+
+  // Level by level, without recursion (see in_order).
+  static int _tree_height(Node<T> *node) {
+    std::vector<Node<T> *> level, next;
+    if (node)
+      level.push_back(node);
+    int height = 0;
+    for (; !level.empty(); height++, level.swap(next)) {
+      next.clear();
+      for (Node<T> *current : level) {
+        if (current->left)
+          next.push_back(current->left);
+        if (current->right)
+          next.push_back(current->right);
+      }
+    }
+    return height;
+  }
+
+  static void _clear(Node<T> *node) {
+    std::vector<Node<T> *> pending;
+    if (node)
+      pending.push_back(node);
+    while (!pending.empty()) {
+      Node<T> *current = pending.back();
+      pending.pop_back();
+      if (current->left)
+        pending.push_back(current->left);
+      if (current->right)
+        pending.push_back(current->right);
+      delete current;
+    }
+  }
+
+  void _BFS(Node<T> *node) {
+    if (node == nullptr)
+      return;
+
+    std::queue<Node<T> *> nodeSequence;
+    nodeSequence.push(node);
+
+    bool first = true;
+    while (!nodeSequence.empty()) {
+      Node<T> *aux = nodeSequence.front();
+      nodeSequence.pop();
+
+      if (first) {
+        std::cout << aux->key;
+        first = false;
+      } else {
+        std::cout << " " << aux->key;
+      }
+
+      if (aux->left)
+        nodeSequence.push(aux->left);
+
+      if (aux->right)
+        nodeSequence.push(aux->right);
+    }
+    std::cout << std::endl;
+  }
+};
+
+#endif
@@ -0,0 +1,508 @@
+#ifndef TREAP_HPP
+#define TREAP_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/Node.hpp"
+#include "../../interfaces/trees/Tree.hpp"
+#include "../Data/FastHash.hpp"
+#include "FrozenTree.hpp"
+#include "utils/treeUtils.cpp"
+#include <algorithm>
+#include <future>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Priority sources for Treap. RandomPriority draws a fresh number per node;
+// HashPriority derives it from the key, so the shape of the tree depends only
+// on the set of keys: runs are reproducible and equal sets give equal trees.
+struct RandomPriority {
+  std::mt19937 rng{std::random_device{}()};
+  template <typename K> unsigned int operator()(const K &) { return rng(); }
+};
+
+template <typename Hash> struct HashPriority {
+  Hash hash;
+  template <typename K> unsigned int operator()(const K &key) {
+    return static_cast<unsigned int>(hash(key) >> 32);
+  }
+};
+
+// Randomized search tree: a binary search tree by key that is also a max-heap
+// by Node<T>::priority. With random priorities its shape is that of a tree
+// built by random insertions, of expected height O(log n), with no balance
+// information to keep up to date.
+//
+// Everything is built on split (cut the tree around a key) and merge (join
+// two trees whose keys do not interleave), both O(log n) expected. unite()
+// merges a whole treap into this one, recursing on independent subtrees;
+// above PARALLEL_CUTOFF nodes the two halves run on separate threads.
+template <typename T, typename Priority = RandomPriority>
+class Treap : public Tree<T> {
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+
+public:
+  Treap() {};
+  explicit Treap(Priority priority) : m_priority(std::move(priority)) {};
+  ~Treap() { clear(); };
+
+  // Data Structure: methods
+  void insert(T value) override {
+    _insert(std::move(value));
+  };
+  void remove(T value) override {
+    _remove(KeyExtractor<T>::getKey(value));
+  };
+
+  // - maximum and minimum
+  T minimum() override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    return _minimum(m_root)->key;
+  };
+  T maximum() override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    return _maximum(m_root)->key;
+  };
+
+  // - successor and predecessor.
+  T successor(T value) override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    Node<T> *node = _contains(m_root, KeyExtractor<T>::getKey(value));
+    Node<T> *succ = node ? _next(node) : nullptr;
+    if (succ == nullptr)
+      throw std::runtime_error("No successor exists for this value");
+    return succ->key;
+  };
+  T predecessor(T value) override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    Node<T> *node = _contains(m_root, KeyExtractor<T>::getKey(value));
+    Node<T> *pred = node ? _prev(node) : nullptr;
+    if (pred == nullptr)
+      throw std::runtime_error("No predecessor exists for this value");
+    return pred->key;
+  };
+
+  // - others datastructures methods.
+  bool contains(T k) const override {
+    return _contains(m_root, KeyExtractor<T>::getKey(k)) != nullptr;
+  };
+
+  bool isEmpty() override { return !m_root; };
+  void clear() override {
+    _clear(m_root);
+    m_root = nullptr;
+  };
+
+  // Tree methods
+  int size() override { return subtree_size(m_root); };
+  int height() override { return _tree_height(m_root); };
+  void BFS() override { _BFS(m_root); };
+  Node<T> *getRoot() const override { return m_root; }
+  Node<T> *&getRootRef() override { return m_root; }
+  // The caller may change the count through the returned node and report
+  // it with countChanged.
+  Node<T> *getNode(const T &value) override {
+    return _contains(m_root, KeyExtractor<T>::getKey(value));
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    this->in_order([&result](Node<T> *node) { result.push_back(node->key); });
+    return result;
+  }
+
+  // Replaces the content with a treap built in O(n) from elements sorted by
+  // key without duplicates.
+  void buildFromSorted(const std::vector<T> &sorted) {
+    clear();
+    std::vector<Node<T> *> nodes;
+    nodes.reserve(sorted.size());
+    for (const T &value : sorted)
+      nodes.push_back(_make_node(value));
+    m_root = _build(nodes);
+  }
+
+  // Moves every element of `other` into this treap, leaving it empty. For a
+  // key present in both, merge(mine, theirs) combines the two elements into
+  // the one kept here (e.g. adding the counts). With m and n elements
+  // (m <= n) this takes O(m log(n / m + 1)) expected work, and the
+  // recursion runs in parallel on large inputs, so merge must not touch
+  // shared state. Both treaps must use the same kind of priorities.
+  template <typename Merge> void unite(Treap &other, Merge merge) {
+    if (this == &other)
+      return;
+    m_root = _detach(_unite(m_root, other.m_root, true, merge, 0));
+    other.m_root = nullptr;
+  }
+  // Keeps this treap's element when a key is in both.
+  void unite(Treap &other) {
+    unite(other, [](T &, const T &) {});
+  }
+
+  // Inserts many elements at once: they are sorted into a treap of their
+  // own, built in linear time, which is then united with this one. Like
+  // insert(), an existing key keeps its element, and so does the first
+  // occurrence of a key repeated in `values`.
+  void insertBulk(std::vector<T> values) {
+    std::stable_sort(values.begin(), values.end(),
+                     [](const T &a, const T &b) {
+                       return KeyExtractor<T>::getKey(a) <
+                              KeyExtractor<T>::getKey(b);
+                     });
+    auto last =
+        std::unique(values.begin(), values.end(), [](const T &a, const T &b) {
+          return KeyExtractor<T>::getKey(a) == KeyExtractor<T>::getKey(b);
+        });
+    values.erase(last, values.end());
+
+    std::vector<Node<T> *> nodes;
+    nodes.reserve(values.size());
+    for (T &value : values)
+      nodes.push_back(_make_node(std::move(value)));
+
+    auto keepMine = [](T &, const T &) {};
+    m_root = _detach(_unite(m_root, _build(nodes), true, keepMine, 0));
+  }
+
+  // Splits off every element with a key greater than or equal to `value`'s
+  // into `greater`, whose previous content is dropped. O(log n) expected.
+  void split(const T &value, Treap &greater) {
+    greater.clear();
+    Node<T> *left, *right;
+    Node<T> *equal =
+        _split(m_root, KeyExtractor<T>::getKey(value), left, right);
+    if (equal)
+      right = _merge(equal, right);
+    m_root = _detach(left);
+    greater.m_root = _detach(right);
+  }
+
+  // Appends `greater`, whose keys must all be greater than this treap's,
+  // leaving it empty. O(log n) expected.
+  void merge(Treap &greater) {
+    if (this == &greater)
+      return;
+    if (m_root && greater.m_root &&
+        !(KeyExtractor<T>::getKey(_maximum(m_root)->key) <
+          KeyExtractor<T>::getKey(_minimum(greater.m_root)->key)))
+      throw std::logic_error("Treap::merge needs all keys of the right-hand "
+                             "treap to be greater");
+    m_root = _detach(_merge(m_root, greater.m_root));
+    greater.m_root = nullptr;
+  }
+
+  // Immutable, pointer-free copy for read-mostly phases.
+  FrozenTree<T> freeze() const {
+    std::vector<T> sorted;
+    sorted.reserve(subtree_size(m_root));
+    this->in_order([&sorted](Node<T> *node) { sorted.push_back(node->key); });
+    return FrozenTree<T>(sorted);
+  }
+
+private:
+  Node<T> *m_root{nullptr};
+  Priority m_priority;
+
+  // Below this many nodes a union is cheaper than starting a thread; the
+  // depth bound keeps the number of threads at 2^PARALLEL_DEPTH.
+  static constexpr unsigned int PARALLEL_CUTOFF = 1u << 14;
+  static constexpr int PARALLEL_DEPTH = 4;
+
+  Node<T> *_make_node(T value) {
+    unsigned int priority = m_priority(KeyExtractor<T>::getKey(value));
+    Node<T> *node = new Node<T>(std::move(value));
+    node->priority = priority;
+    return node;
+  }
+
+  // Recomputes the subtree summaries of `node` and points its children back
+  // at it.
+  static void _pull(Node<T> *node) {
+    if (node->left)
+      node->left->parent = node;
+    if (node->right)
+      node->right->parent = node;
+    update_subtree_size(node);
+  }
+
+  static Node<T> *_detach(Node<T> *root) {
+    if (root)
+      root->parent = nullptr;
+    return root;
+  }
+
+  // Cuts `node` into `left` (keys smaller than `key`) and `right` (greater
+  // keys). The node holding `key`, if any, is returned on its own. The
+  // parent pointers of the two roots are left for the caller to set.
+  static Node<T> *_split(Node<T> *node, const KeyType &key, Node<T> *&left,
+                         Node<T> *&right) {
+    if (!node) {
+      left = right = nullptr;
+      return nullptr;
+    }
+
+    const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+    Node<T> *equal;
+    if (key < nodeKey) {
+      equal = _split(node->left, key, left, node->left);
+      right = node;
+    } else if (nodeKey < key) {
+      equal = _split(node->right, key, node->right, right);
+      left = node;
+    } else {
+      left = node->left;
+      right = node->right;
+      node->left = node->right = nullptr;
+      equal = node;
+    }
+    _pull(node);
+    return equal;
+  }
+
+  // Joins two treaps where every key of `left` is smaller than every key of
+  // `right`.
+  static Node<T> *_merge(Node<T> *left, Node<T> *right) {
+    if (!left)
+      return right;
+    if (!right)
+      return left;
+    if (left->priority > right->priority) {
+      left->right = _merge(left->right, right);
+      _pull(left);
+      return left;
+    }
+    right->left = _merge(left, right->left);
+    _pull(right);
+    return right;
+  }
+
+  // The root with the higher priority stays on top; the other treap is split
+  // around its key and each half is united with the matching subtree.
+  // `aIsMine` tells which side `a` came from, for the merge functor.
+  template <typename Merge>
+  static Node<T> *_unite(Node<T> *a, Node<T> *b, bool aIsMine, Merge &merge,
+                         int depth) {
+    if (!a)
+      return b;
+    if (!b)
+      return a;
+    if (a->priority < b->priority) {
+      std::swap(a, b);
+      aIsMine = !aIsMine;
+    }
+
+    bool parallel =
+        depth < PARALLEL_DEPTH && a->size + b->size >= PARALLEL_CUTOFF;
+    Node<T> *left, *right;
+    Node<T> *equal = _split(b, KeyExtractor<T>::getKey(a->key), left, right);
+    if (equal) {
+      if (aIsMine) {
+        merge(a->key, equal->key);
+      } else {
+        merge(equal->key, a->key);
+        a->key = std::move(equal->key);
+      }
+      delete equal;
+    }
+
+    if (parallel) {
+      auto leftTask = std::async(std::launch::async, [&] {
+        return _unite(a->left, left, aIsMine, merge, depth + 1);
+      });
+      a->right = _unite(a->right, right, aIsMine, merge, depth + 1);
+      a->left = leftTask.get();
+    } else {
+      a->left = _unite(a->left, left, aIsMine, merge, depth + 1);
+      a->right = _unite(a->right, right, aIsMine, merge, depth + 1);
+    }
+    _pull(a);
+    return a;
+  }
+
+  // Cartesian tree construction over nodes sorted by key: the right spine is
+  // kept on a stack and each new node pops the ones with lower priority,
+  // which become its left subtree.
+  static Node<T> *_build(const std::vector<Node<T> *> &nodes) {
+    std::vector<Node<T> *> spine;
+    for (Node<T> *node : nodes) {
+      Node<T> *popped = nullptr;
+      while (!spine.empty() && spine.back()->priority < node->priority) {
+        popped = spine.back();
+        spine.pop_back();
+      }
+      node->left = popped;
+      if (popped)
+        popped->parent = node;
+      if (!spine.empty()) {
+        spine.back()->right = node;
+        node->parent = spine.back();
+      }
+      spine.push_back(node);
+    }
+    if (spine.empty())
+      return nullptr;
+    _resize(spine.front());
+    return _detach(spine.front());
+  }
+
+  static void _resize(Node<T> *node) {
+    if (!node)
+      return;
+    _resize(node->left);
+    _resize(node->right);
+    update_subtree_size(node);
+  }
+
+  int _tree_height(Node<T> *node) const {
+    if (!node)
+      return 0;
+    return 1 + std::max(_tree_height(node->left), _tree_height(node->right));
+  }
+
+  Node<T> *_contains(Node<T> *node, const KeyType &key) const {
+    while (node) {
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      PERF_TRACKER.incrementComparisons();
+
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key == nodeKey)
+        return node;
+      node = key < nodeKey ? node->left : node->right;
+    }
+    return nullptr;
+  }
+
+  // Insertion: descends while the nodes outrank the new one, then splits the
+  // subtree found there around the key and hangs the halves below the new
+  // node. A duplicate further down is put back by merging the split parts,
+  // which rebuilds exactly the same subtree.
+  void _insert(T value) {
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    unsigned int priority = m_priority(key);
+    Node<T> *parent = nullptr;
+    Node<T> **slot = &m_root;
+
+    while (*slot && (*slot)->priority >= priority) {
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementComparisons();
+
+      const KeyType &nodeKey = KeyExtractor<T>::getKey((*slot)->key);
+      if (key == nodeKey)
+        return;
+      parent = *slot;
+      slot = key < nodeKey ? &parent->left : &parent->right;
+    }
+
+    Node<T> *left, *right;
+    if (Node<T> *equal = _split(*slot, key, left, right)) {
+      *slot = _merge(_merge(left, equal), right);
+      (*slot)->parent = parent;
+      return;
+    }
+
+    PERF_TRACKER.incrementInsertionFixups();
+    Node<T> *node = new Node<T>(std::move(value), left, right, parent);
+    node->priority = priority;
+    _pull(node);
+    *slot = node;
+    for (; parent; parent = parent->parent) {
+      parent->size++;
+      parent->maxCount = std::max(parent->maxCount, node->maxCount);
+    }
+  }
+
+  // Removal: the node is replaced by the merge of its two subtrees.
+  void _remove(const KeyType &key) {
+    Node<T> *target = _contains(m_root, key);
+    if (!target)
+      return;
+
+    PERF_TRACKER.incrementDeletionFixups();
+    Node<T> *parent = target->parent;
+    Node<T> *child = _merge(target->left, target->right);
+    if (child)
+      child->parent = parent;
+    if (!parent)
+      m_root = child;
+    else if (parent->left == target)
+      parent->left = child;
+    else
+      parent->right = child;
+    delete target;
+    update_subtree_size_upwards(parent);
+  }
+
+  static Node<T> *_minimum(Node<T> *node) {
+    while (node->left)
+      node = node->left;
+    return node;
+  }
+
+  static Node<T> *_maximum(Node<T> *node) {
+    while (node->right)
+      node = node->right;
+    return node;
+  }
+
+  static Node<T> *_next(Node<T> *node) {
+    if (node->right)
+      return _minimum(node->right);
+    while (node->parent && node->parent->right == node)
+      node = node->parent;
+    return node->parent;
+  }
+
+  static Node<T> *_prev(Node<T> *node) {
+    if (node->left)
+      return _maximum(node->left);
+    while (node->parent && node->parent->left == node)
+      node = node->parent;
+    return node->parent;
+  }
+
+  static void _clear(Node<T> *node) {
+    if (!node)
+      return;
+    _clear(node->left);
+    _clear(node->right);
+    delete node;
+  }
+
+  void _BFS(Node<T> *node) {
+    if (node == nullptr)
+      return;
+
+    std::queue<Node<T> *> nodeSequence;
+    nodeSequence.push(node);
+
+    bool first = true;
+    while (!nodeSequence.empty()) {
+      Node<T> *aux = nodeSequence.front();
+      nodeSequence.pop();
+
+      if (first) {
+        std::cout << aux->key;
+        first = false;
+      } else {
+        std::cout << " " << aux->key;
+      }
+
+      if (aux->left)
+        nodeSequence.push(aux->left);
+
+      if (aux->right)
+        nodeSequence.push(aux->right);
+    }
+    std::cout << std::endl;
+  }
+};
+
+#endif
@@ -0,0 +1,360 @@
+#ifndef WAVLTREE_HPP
+#define WAVLTREE_HPP
+
+#include "../../PerformanceTracker.hpp"
+#include "../../interfaces/core/Node.hpp"
+#include "../../interfaces/trees/rotatable/RotatableTree.hpp"
+#include "FrozenTree.hpp"
+#include "contexts/AVLTree/RotationContext.hpp"
+#include "utils/treeUtils.cpp"
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+// Weak AVL (rank-balanced) tree. Every node has a rank, kept in
+// Node<T>::height as rank + 1 so a missing child counts as 0, and every
+// parent-child rank difference is 1 or 2 with leaves at rank 0 (1 here).
+// Without deletions this is exactly an AVL tree and the ranks are the
+// heights; deletions only demote ranks, so the tree never gets taller than
+// an AVL tree built by the same insertions.
+//
+// Rebalancing is mostly promotions and demotions: an insertion does at most
+// two rotations and so does a deletion, where an AVL tree may rotate at
+// every level. The rotations reuse the AVL rotation context, which rewrites
+// the height of the rotated nodes, so their ranks are set right after it.
+template <typename T,
+          template <typename> class RotationCtx = AVLRotationContext>
+class WAVLTree : public RotatableTree<T, RotationCtx> {
+  using Base = RotatableTree<T, RotationCtx>;
+  using Base::_rotate_left;
+  using Base::_rotate_right;
+
+  using KeyType = decltype(KeyExtractor<T>::getKey(std::declval<T>()));
+
+public:
+  WAVLTree() {};
+  ~WAVLTree() { clear(); };
+
+  // Data Structure: methods
+  void insert(T value) override {
+    _insert(std::move(value));
+  };
+  void remove(T value) override {
+    _remove(KeyExtractor<T>::getKey(value));
+  };
+
+  // - maximum and minimum
+  T minimum() override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    return _minimum(m_root)->key;
+  };
+  T maximum() override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    return _maximum(m_root)->key;
+  };
+
+  // - successor and predecessor.
+  T successor(T value) override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    Node<T> *node = _contains(m_root, KeyExtractor<T>::getKey(value));
+    Node<T> *succ = node ? _next(node) : nullptr;
+    if (succ == nullptr)
+      throw std::runtime_error("No successor exists for this value");
+    return succ->key;
+  };
+  T predecessor(T value) override {
+    if (isEmpty())
+      throw std::runtime_error("Tree is empty");
+    Node<T> *node = _contains(m_root, KeyExtractor<T>::getKey(value));
+    Node<T> *pred = node ? _prev(node) : nullptr;
+    if (pred == nullptr)
+      throw std::runtime_error("No predecessor exists for this value");
+    return pred->key;
+  };
+
+  // - others datastructures methods.
+  bool contains(T k) const override {
+    return _contains(m_root, KeyExtractor<T>::getKey(k)) != nullptr;
+  };
+
+  bool isEmpty() override { return !m_root; };
+  void clear() override {
+    _clear(m_root);
+    m_root = nullptr;
+  };
+
+  // Tree methods
+  int size() override { return subtree_size(m_root); };
+  // The real height: after deletions ranks may exceed it.
+  int height() override { return _tree_height(m_root); };
+  void BFS() override { _BFS(m_root); };
+  Node<T> *getRoot() const override { return m_root; }
+  Node<T> *&getRootRef() override { return m_root; }
+  // The caller may change the count through the returned node and report
+  // it with countChanged.
+  Node<T> *getNode(const T &value) override {
+    return _contains(m_root, KeyExtractor<T>::getKey(value));
+  }
+
+  std::vector<std::pair<std::string, int>> getOrderedContent() const override {
+    std::vector<std::pair<std::string, int>> result;
+    this->in_order([&result](Node<T> *node) { result.push_back(node->key); });
+    return result;
+  }
+
+  // Replaces the content with a perfectly balanced tree built in O(n) from
+  // elements sorted by key without duplicates. Its heights are valid ranks.
+  void buildFromSorted(const std::vector<T> &sorted) {
+    clear();
+    m_root = build_balanced<T>(sorted, 0, sorted.size(), nullptr, 0,
+                               static_cast<size_t>(-1));
+  }
+
+  // Immutable, pointer-free copy for read-mostly phases.
+  FrozenTree<T> freeze() const {
+    std::vector<T> sorted;
+    sorted.reserve(subtree_size(m_root));
+    this->in_order([&sorted](Node<T> *node) { sorted.push_back(node->key); });
+    return FrozenTree<T>(sorted);
+  }
+
+private:
+  Node<T> *m_root{nullptr};
+
+  static int _rank(Node<T> *node) { return node ? node->height : 0; }
+
+  static bool _is_leaf(Node<T> *node) { return !node->left && !node->right; }
+
+  static Node<T> *_sibling(Node<T> *parent, Node<T> *child) {
+    return parent->left == child ? parent->right : parent->left;
+  }
+
+  // Rotates `child` above its parent, whichever side it is on.
+  Node<T> *_rotate_up(Node<T> *child) {
+    Node<T> *parent = child->parent;
+    return parent->left == child ? _rotate_right(parent, m_root)
+                                 : _rotate_left(parent, m_root);
+  }
+
+  int _tree_height(Node<T> *node) const {
+    if (!node)
+      return 0;
+    return 1 + std::max(_tree_height(node->left), _tree_height(node->right));
+  }
+
+  Node<T> *_contains(Node<T> *node, const KeyType &key) const {
+    while (node) {
+      PERF_TRACKER.incrementNodesVisited();
+      PERF_TRACKER.incrementSearchDepth();
+      PERF_TRACKER.incrementComparisons();
+
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key == nodeKey)
+        return node;
+      node = key < nodeKey ? node->left : node->right;
+    }
+    return nullptr;
+  }
+
+  // Insertion: the new leaf has rank 0. While a node has the same rank as
+  // its parent, the parent is promoted if its other child is a 1-child;
+  // otherwise one single or double rotation ends the rebalancing.
+  void _insert(T value) {
+    const KeyType &key = KeyExtractor<T>::getKey(value);
+    Node<T> *parent = nullptr;
+    bool goLeft = false;
+
+    for (Node<T> *node = m_root; node;) {
+      const KeyType &nodeKey = KeyExtractor<T>::getKey(node->key);
+      if (key < nodeKey) {
+        goLeft = true;
+      } else if (nodeKey < key) {
+        goLeft = false;
+      } else {
+        return;
+      }
+      parent = node;
+      node = goLeft ? node->left : node->right;
+    }
+
+    Node<T> *node = new Node<T>(std::move(value));
+    if (!parent) {
+      m_root = node;
+      return;
+    }
+    node->parent = parent;
+    (goLeft ? parent->left : parent->right) = node;
+    update_subtree_size_upwards(parent);
+
+    while (parent && _rank(parent) == _rank(node)) {
+      Node<T> *sibling = _sibling(parent, node);
+      if (_rank(parent) - _rank(sibling) == 1) {
+        parent->height++;
+        node = parent;
+        parent = node->parent;
+        continue;
+      }
+
+      // `parent` is a 0,2 node; `node` is 1,2 after its promotion.
+      PERF_TRACKER.incrementInsertionFixups();
+      Node<T> *inner = parent->left == node ? node->right : node->left;
+      unsigned int parentRank = parent->height;
+      if (_rank(node) - _rank(inner) == 2) {
+        _rotate_up(node);
+        parent->height = parentRank - 1;
+        node->height = parentRank;
+      } else {
+        _rotate_up(inner);
+        _rotate_up(inner);
+        inner->height = parentRank;
+        node->height = parentRank - 1;
+        parent->height = parentRank - 1;
+      }
+      return;
+    }
+  }
+
+  // Deletion: a node with two children trades its key with its successor,
+  // which is then unlinked. A 3-child, or a leaf left with rank 1, demotes
+  // its parent (and its sibling when both the sibling's children are
+  // 2-children) upwards; otherwise one single or double rotation at the
+  // sibling ends the rebalancing.
+  void _remove(const KeyType &key) {
+    Node<T> *target = _contains(m_root, key);
+    if (!target)
+      return;
+
+    if (target->left && target->right) {
+      Node<T> *succ = _minimum(target->right);
+      target->key = std::move(succ->key);
+      target = succ;
+    }
+
+    Node<T> *child = target->left ? target->left : target->right;
+    Node<T> *parent = target->parent;
+    if (child)
+      child->parent = parent;
+    if (!parent)
+      m_root = child;
+    else if (parent->left == target)
+      parent->left = child;
+    else
+      parent->right = child;
+    delete target;
+    update_subtree_size_upwards(parent);
+
+    if (parent && _is_leaf(parent) && _rank(parent) == 2) {
+      parent->height = 1;
+      child = parent;
+      parent = parent->parent;
+    }
+
+    while (parent && _rank(parent) - _rank(child) == 3) {
+      Node<T> *sibling = _sibling(parent, child);
+      if (_rank(parent) - _rank(sibling) == 2) {
+        parent->height--;
+        child = parent;
+        parent = parent->parent;
+        continue;
+      }
+
+      Node<T> *outer = parent->left == sibling ? sibling->left : sibling->right;
+      Node<T> *inner = parent->left == sibling ? sibling->right : sibling->left;
+      if (_rank(sibling) - _rank(outer) == 2 &&
+          _rank(sibling) - _rank(inner) == 2) {
+        parent->height--;
+        sibling->height--;
+        child = parent;
+        parent = parent->parent;
+        continue;
+      }
+
+      PERF_TRACKER.incrementDeletionFixups();
+      unsigned int parentRank = parent->height;
+      unsigned int siblingRank = sibling->height;
+      if (_rank(sibling) - _rank(outer) == 1) {
+        _rotate_up(sibling);
+        sibling->height = siblingRank + 1;
+        parent->height = _is_leaf(parent) ? 1 : parentRank - 1;
+      } else {
+        unsigned int innerRank = inner->height;
+        _rotate_up(inner);
+        _rotate_up(inner);
+        inner->height = innerRank + 2;
+        sibling->height = siblingRank - 1;
+        parent->height = parentRank - 2;
+      }
+      return;
+    }
+  }
+
+  static Node<T> *_minimum(Node<T> *node) {
+    while (node->left)
+      node = node->left;
+    return node;
+  }
+
+  static Node<T> *_maximum(Node<T> *node) {
+    while (node->right)
+      node = node->right;
+    return node;
+  }
+
+  static Node<T> *_next(Node<T> *node) {
+    if (node->right)
+      return _minimum(node->right);
+    while (node->parent && node->parent->right == node)
+      node = node->parent;
+    return node->parent;
+  }
+
+  static Node<T> *_prev(Node<T> *node) {
+    if (node->left)
+      return _maximum(node->left);
+    while (node->parent && node->parent->left == node)
+      node = node->parent;
+    return node->parent;
+  }
+
+  static void _clear(Node<T> *node) {
+    if (!node)
+      return;
+    _clear(node->left);
+    _clear(node->right);
+    delete node;
+  }
+
+  void _BFS(Node<T> *node) {
+    if (node == nullptr)
+      return;
+
+    std::queue<Node<T> *> nodeSequence;
+    nodeSequence.push(node);
+
+    bool first = true;
+    while (!nodeSequence.empty()) {
+      Node<T> *aux = nodeSequence.front();
+      nodeSequence.pop();
+
+      if (first) {
+        std::cout << aux->key;
+        first = false;
+      } else {
+        std::cout << " " << aux->key;
+      }
+
+      if (aux->left)
+        nodeSequence.push(aux->left);
+
+      if (aux->right)
+        nodeSequence.push(aux->right);
+    }
+    std::cout << std::endl;
+  }
+};
+
+#endif
@@ -85,7 +85,8 @@ enum class AVLDeletionCase {
 };
 
 template <typename T>
-struct AVLDeletionContext : public FixupContext<AVLDeletionCase, T> {
+struct AVLDeletionContext final
+    : public FixupContext<AVLDeletionContext<T>, AVLDeletionCase, T> {
   Node<T> *node{nullptr};
   Node<T> *childrens[2]{nullptr, nullptr};
   Node<T> *parent{nullptr};
@@ -175,7 +176,7 @@ struct AVLDeletionContext : public FixupContext<AVLDeletionCase, T> {
     return false;
   }
 
-  AVLDeletionCase getCase() const override {
+  AVLDeletionCase getCase() const {
     if (node == m_root)
       return AVLDeletionCase::CASEROOT;
 
@@ -212,7 +213,7 @@ struct AVLDeletionContext : public FixupContext<AVLDeletionCase, T> {
     return AVLDeletionCase::CASE1A;
   }
 
-  Node<T> *useCaseAction() override {
+  Node<T> *useCaseAction() {
     if (!node)
       return m_root;
 
@@ -232,9 +233,7 @@ struct AVLDeletionContext : public FixupContext<AVLDeletionCase, T> {
     return m_root;
   }
 
-  Node<T> *fixupAction(
-      std::function<Node<T> *(Node<T> *)> rotateLeft = nullptr,
-      std::function<Node<T> *(Node<T> *)> rotateRight = nullptr) override {
+  Node<T> *fixupAction() {
     AVLDeletionCase case_type = getCase();
     
     // Track deletion fixups
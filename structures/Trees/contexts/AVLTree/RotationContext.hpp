@@ -49,6 +49,9 @@ template <typename T> struct AVLRotationContext {
     node->height = 1 + greater_children_height(node);
     children->height = 1 + greater_children_height(children);
 
+    update_subtree_size(node);
+    update_subtree_size(children);
+
     return children;
   }
 };
@@ -84,7 +84,8 @@ enum class RBDeletionCase {
 };
 
 template <typename T>
-struct RBDeletionContext : public FixupContext<RBDeletionCase, T> {
+struct RBDeletionContext final
+    : public FixupContext<RBDeletionContext<T>, RBDeletionCase, T> {
   Node<T> *node{nullptr};
   Node<T> *childrens[2]{nullptr, nullptr};
   Node<T> *parent{nullptr};
@@ -174,7 +175,7 @@ struct RBDeletionContext : public FixupContext<RBDeletionCase, T> {
     return false;
   }
 
-  RBDeletionCase getCase() const override {
+  RBDeletionCase getCase() const {
     if (node == m_root)
       return RBDeletionCase::CASEROOT;
 
@@ -210,7 +211,7 @@ struct RBDeletionContext : public FixupContext<RBDeletionCase, T> {
     return RBDeletionCase::CASE1A;
   }
 
-  Node<T> *useCaseAction() override {
+  Node<T> *useCaseAction() {
     if (!node)
       return m_root;
 
@@ -230,9 +231,7 @@ struct RBDeletionContext : public FixupContext<RBDeletionCase, T> {
     return m_root;
   }
 
-  Node<T> *fixupAction(
-      std::function<Node<T> *(Node<T> *)> rotateLeft = nullptr,
-      std::function<Node<T> *(Node<T> *)> rotateRight = nullptr) override {
+  Node<T> *fixupAction() {
     RBDeletionCase case_type = getCase();
     
     // Track deletion fixups
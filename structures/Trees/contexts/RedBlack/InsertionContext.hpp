@@ -40,7 +40,9 @@ enum class RBInsertionCase {
 };
 
 template <typename T, typename RotationCtx = RBRotationContext<T>>
-struct RBInsertionContext : public FixupContext<RBInsertionCase, T> {
+struct RBInsertionContext final
+    : public FixupContext<RBInsertionContext<T, RotationCtx>, RBInsertionCase,
+                          T> {
   Node<T> *node{nullptr};
   Node<T> *parent{nullptr};
   Node<T> *grandparent{nullptr};
@@ -80,7 +82,7 @@ struct RBInsertionContext : public FixupContext<RBInsertionCase, T> {
   bool hasGrandParent() const { return !!grandparent; }
   bool hasUncle() const { return !!uncle; }
 
-  RBInsertionCase getCase() const override {
+  RBInsertionCase getCase() const {
     if (!hasParent() || !hasGrandParent())
       return RBInsertionCase::ROOT;
 
@@ -99,7 +101,7 @@ struct RBInsertionContext : public FixupContext<RBInsertionCase, T> {
     }
   }
 
-  Node<T> *useCaseAction() override {
+  Node<T> *useCaseAction() {
     Node<T> *current = m_root;
 
     while (current) {
@@ -122,28 +124,31 @@ struct RBInsertionContext : public FixupContext<RBInsertionCase, T> {
     return node;
   }
 
-  Node<T> *fixupAction() override {
+  // Walks up only while there is a red-red violation: a red uncle moves it to
+  // the grandparent, a rotation ends it, anything else means it is gone.
+  Node<T> *fixupAction() {
     Node<T> *inserted_node = node;
 
-    while (node) {
+    while (true) {
       updateRelatives();
       RBInsertionCase case_type = getCase();
-      
+
       // Track fixup operations
-      if (case_type != RBInsertionCase::ROOT && case_type != RBInsertionCase::NOFIXUP) {
+      if (case_type != RBInsertionCase::ROOT &&
+          case_type != RBInsertionCase::NOFIXUP) {
         PERF_TRACKER.incrementInsertionFixups();
       }
 
       switch (case_type) {
       case RBInsertionCase::ROOT:
-        if (node == m_root) {
+        if (node == m_root && node->color != BLACK) {
           node->color = BLACK;
           PERF_TRACKER.incrementColorChanges();
         }
-        break;
+        return inserted_node;
 
       case RBInsertionCase::NOFIXUP:
-        break;
+        return inserted_node;
 
       case RBInsertionCase::REDUNCLE:
         parent->color = BLACK;
@@ -154,31 +159,28 @@ struct RBInsertionContext : public FixupContext<RBInsertionCase, T> {
           grandparent->color = RED;
           PERF_TRACKER.incrementColorChanges(); // grandparent
         }
-        break;
+        node = grandparent;
+        continue;
 
       case RBInsertionCase::ZIGLEFTRIGHT:
         RotationCtx::rotate(parent, m_root, Direction::LEFT);
         RotationCtx::rotate(grandparent, m_root, Direction::RIGHT);
-        break;
+        return inserted_node;
 
       case RBInsertionCase::ZIGRIGHTLEFT:
         RotationCtx::rotate(parent, m_root, Direction::RIGHT);
         RotationCtx::rotate(grandparent, m_root, Direction::LEFT);
-        break;
+        return inserted_node;
 
       case RBInsertionCase::LINEARLEFT:
         RotationCtx::rotate(grandparent, m_root, Direction::RIGHT);
-        break;
+        return inserted_node;
 
       case RBInsertionCase::LINEARRIGHT:
         RotationCtx::rotate(grandparent, m_root, Direction::LEFT);
-        break;
+        return inserted_node;
       }
-
-      node = node->parent;
     }
-
-    return inserted_node;
   }
 };
 
@@ -3,6 +3,7 @@
 
 #include "../../../../interfaces/core/Node.hpp"
 #include "../../../../interfaces/enum/RotationDirection.hpp"
+#include "../../utils/treeUtils.cpp"
 #include "../../../../PerformanceTracker.hpp"
 #include <stdexcept>
 #include <utility>
@@ -50,6 +51,9 @@ template <typename T> struct RBRotationContext {
 
     std::swap(children->color, node->color);
 
+    update_subtree_size(node);
+    update_subtree_size(children);
+
     return children;
   }
 };
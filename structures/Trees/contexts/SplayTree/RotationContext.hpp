@@ -0,0 +1,58 @@
+#ifndef SPLAY_ROTATION_CONTEXT_HPP
+#define SPLAY_ROTATION_CONTEXT_HPP
+
+#include "../../../../interfaces/core/Node.hpp"
+#include "../../../../interfaces/enum/RotationDirection.hpp"
+#include "../../utils/treeUtils.cpp"
+#include "../../../../PerformanceTracker.hpp"
+#include <stdexcept>
+
+// Splay trees keep no balance information, so a rotation only relinks the
+// nodes and refreshes the two subtree sizes.
+template <typename T> struct SplayRotationContext {
+  static Node<T> *rotate(Node<T> *node, Node<T> *&m_root, Direction dir) {
+    if (!node)
+      throw std::invalid_argument("Cannot rotate null node");
+
+    PERF_TRACKER.incrementRotations();
+
+    Node<T> *parent = node->parent;
+    Node<T> *children = (dir == LEFT) ? node->right : node->left;
+
+    if (!children)
+      throw std::logic_error("Cannot perform rotation: child is null");
+
+    Node<T> *childrenOrphan = (dir == LEFT) ? children->left : children->right;
+
+    if (dir == LEFT) {
+      node->right = childrenOrphan;
+      if (childrenOrphan)
+        childrenOrphan->parent = node;
+      children->left = node;
+    } else {
+      node->left = childrenOrphan;
+      if (childrenOrphan)
+        childrenOrphan->parent = node;
+      children->right = node;
+    }
+
+    node->parent = children;
+    children->parent = parent;
+
+    if (node == m_root) {
+      m_root = children;
+    } else if (parent) {
+      if (parent->left == node)
+        parent->left = children;
+      else
+        parent->right = children;
+    }
+
+    update_subtree_size(node);
+    update_subtree_size(children);
+
+    return children;
+  }
+};
+
+#endif
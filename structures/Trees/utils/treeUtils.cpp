@@ -2,6 +2,7 @@
 #define TREE_UTILS_HPP
 
 #include "../../../interfaces/core/Node.hpp"
+#include <algorithm>
 #include <iostream>
 #include <stack>
 #include <vector>
@@ -11,6 +12,50 @@ template <typename T> int greater_children_height(Node<T> *node) {
                   node->right ? node->right->height : 0);
 }
 
+template <typename T> unsigned int subtree_size(Node<T> *node) {
+  return node ? node->size : 0;
+}
+
+template <typename T> int subtree_max_count(Node<T> *node) {
+  return node ? node->maxCount : 0;
+}
+
+// Recomputes what a node summarizes of its subtree from its children: the
+// size and the largest count (Tree::topKByPrefix).
+template <typename T> void update_subtree_size(Node<T> *node) {
+  node->size = 1 + subtree_size(node->left) + subtree_size(node->right);
+  node->maxCount =
+      std::max({element_count(node->key), subtree_max_count(node->left),
+                subtree_max_count(node->right)});
+}
+
+// Recomputes the subtree summaries from `node` up to the root, used after a
+// structural change that did not go through a rotation.
+template <typename T> void update_subtree_size_upwards(Node<T> *node) {
+  for (; node; node = node->parent)
+    update_subtree_size(node);
+}
+
+// Builds a perfectly balanced subtree from the sorted range [lo, hi) in O(n)
+// and returns its root, with height, size and parent links filled in. Nodes
+// at `redDepth` (the incomplete last level, for red-black trees) are colored
+// red and every other node black.
+template <typename T>
+Node<T> *build_balanced(const std::vector<T> &sorted, size_t lo, size_t hi,
+                        Node<T> *parent, size_t depth, size_t redDepth) {
+  if (lo >= hi)
+    return nullptr;
+
+  size_t mid = lo + (hi - lo) / 2;
+  Node<T> *node = new Node<T>(sorted[mid], parent,
+                              depth == redDepth ? RED : BLACK);
+  node->left = build_balanced(sorted, lo, mid, node, depth + 1, redDepth);
+  node->right = build_balanced(sorted, mid + 1, hi, node, depth + 1, redDepth);
+  node->height = 1 + greater_children_height(node);
+  update_subtree_size(node);
+  return node;
+}
+
 template <typename T> static void printValues(Node<T> *node) {
   if (node) {
     std::cout << node->key << " ";